@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_ATTRIBUTEPATH_H
+#define VELOCYPACK_ATTRIBUTEPATH_H 1
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+class AttributePath {
+  // A path of attribute names that is looked up in many documents of
+  // the same layout. For every component the position in the index
+  // table of the Object where it was last found is remembered. The next
+  // lookup reads the key at that position and compares it once, and
+  // only searches the Object if the key differs. Compact Objects have
+  // no index table and are always searched.
+  // An AttributePath is modified by get() and must not be shared
+  // between threads.
+
+ public:
+  AttributePath(std::initializer_list<std::string> components);
+  explicit AttributePath(std::vector<std::string> const& components);
+  explicit AttributePath(std::vector<StringRef> const& components);
+
+  // look for the path inside an Object
+  // returns a Slice(ValueType::None) if not found
+  Slice get(Slice slice, bool resolveExternals = false);
+
+  std::size_t size() const noexcept { return _components.size(); }
+
+  // number of components found at their remembered position
+  uint64_t hits() const noexcept { return _hits; }
+
+  // number of components that had to be searched for
+  uint64_t misses() const noexcept { return _misses; }
+
+ private:
+  struct Component {
+    std::string name;
+    ValueLength index;  // index table position of the last match
+  };
+
+  Slice lookup(Slice object, Component& component);
+
+ private:
+  std::vector<Component> _components;
+  uint64_t _hits;
+  uint64_t _misses;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
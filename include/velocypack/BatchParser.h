@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_BATCHPARSER_H
+#define VELOCYPACK_BATCHPARSER_H 1
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+class Builder;
+
+class BatchParser {
+  // This class parses newline-delimited JSON (one or more JSON values,
+  // separated by line breaks) on several threads. The input is split
+  // into one chunk per thread at line breaks, and each chunk is parsed
+  // by its own Parser into its own Builder. The resulting documents are
+  // then concatenated into one contiguous buffer, in input order, with
+  // an offset table pointing to the start of each document.
+  // The chunks are split at arbitrary line breaks, so no top-level value
+  // may span several lines, as in NDJSON. This is always safe for strings,
+  // because they cannot contain unescaped line breaks.
+  // The chunks are handed to a pool of worker threads through a queue.
+  // The workers are started by the first parse() that needs them and are
+  // reused by all following calls, until the BatchParser is destroyed.
+
+ public:
+  // the number of threads defaults to the number of hardware threads
+  explicit BatchParser(Options const* options = &Options::Defaults,
+                       std::size_t threads = 0);
+
+  ~BatchParser();
+
+  BatchParser(BatchParser const&) = delete;
+  BatchParser& operator=(BatchParser const&) = delete;
+
+  // parses the input and returns the number of documents. throws on
+  // invalid input, in which case errorPos() returns the error position
+  ValueLength parse(std::string const& json) {
+    return parse(reinterpret_cast<uint8_t const*>(json.data()), json.size());
+  }
+
+  ValueLength parse(char const* start, std::size_t size) {
+    return parse(reinterpret_cast<uint8_t const*>(start), size);
+  }
+
+  ValueLength parse(uint8_t const* start, std::size_t size);
+
+  // number of documents parsed by the last call to parse()
+  ValueLength size() const noexcept { return _offsets.size(); }
+
+  // returns a document parsed by the last call to parse()
+  Slice operator[](ValueLength index) const noexcept {
+    VELOCYPACK_ASSERT(index < _offsets.size());
+    return Slice(_buffer.data() + _offsets[index]);
+  }
+
+  Slice at(ValueLength index) const {
+    if (VELOCYPACK_UNLIKELY(index >= _offsets.size())) {
+      throw Exception(Exception::IndexOutOfBounds);
+    }
+    return operator[](index);
+  }
+
+  // all documents, stored back to back
+  Buffer<uint8_t> const& buffer() const noexcept { return _buffer; }
+
+  // start offsets of the documents in buffer()
+  std::vector<ValueLength> const& offsets() const noexcept { return _offsets; }
+
+  // adds all documents as an Array to the builder
+  void toArray(Builder& builder) const;
+
+  // Returns the position in the input at which the last reported
+  // error occurred, only use when handling an exception.
+  std::size_t errorPos() const noexcept { return _errorPos; }
+
+  std::size_t threads() const noexcept { return _threads; }
+
+  // number of worker threads started so far. the calling thread parses
+  // a chunk as well, so this is at most threads() - 1
+  std::size_t workers() const noexcept;
+
+ public:
+  Options const* options;
+
+ private:
+  class WorkerPool;
+
+  std::size_t _threads;
+  std::unique_ptr<WorkerPool> _pool;
+  std::size_t _errorPos;
+  Buffer<uint8_t> _buffer;
+  std::vector<ValueLength> _offsets;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -32,6 +32,7 @@
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Exception.h"
+#include "velocypack/MemoryResource.h"
 
 namespace arangodb {
 namespace velocypack {
@@ -41,21 +42,30 @@ class Buffer {
   static_assert(sizeof(T) == 1, "expecting sizeof(T) to be 1");
 
  public:
-  Buffer() noexcept : _buffer(_local), _capacity(sizeof(_local)), _size(0) {
+  Buffer() noexcept : Buffer(static_cast<MemoryResource*>(nullptr)) {}
+
+  // create a Buffer that allocates its memory from the resource. a
+  // nullptr resource means the default heap
+  explicit Buffer(MemoryResource* resource) noexcept
+      : _buffer(_local), _capacity(sizeof(_local)), _size(0), _reallocations(0),
+        _resource(resource) {
     poison(_buffer, _capacity);
     initWithNone();
   }
 
   explicit Buffer(ValueLength expectedLength) : Buffer() {
     reserve(expectedLength);
+    // the initial allocation is not a reallocation
+    _reallocations = 0;
     initWithNone();
   }
 
+  // note: a copy always uses the default heap, regardless of the
+  // MemoryResource of the original
   Buffer(Buffer const& that) : Buffer() {
     if (that._size > 0) {
       if (that._size > sizeof(that._local)) {
-        _buffer = static_cast<T*>(velocypack_malloc(checkOverflow(that._size)));
-        ensureValidPointer(_buffer);
+        _buffer = allocateMemory(that._size);
         _capacity = that._size;
       } else {
         VELOCYPACK_ASSERT(_buffer == &_local[0]);
@@ -74,13 +84,12 @@ class Buffer {
         memcpy(_buffer, that._buffer, checkOverflow(that._size));
       } else {
         // our own buffer is not big enough to hold the data
-        T* buffer = static_cast<T*>(velocypack_malloc(checkOverflow(that._size)));
-        ensureValidPointer(buffer);
+        T* buffer = allocateMemory(that._size);
         buffer[0] = '\x00';
         memcpy(buffer, that._buffer, checkOverflow(that._size));
 
         if (_buffer != _local) {
-          velocypack_free(_buffer);
+          freeMemory(_buffer, _capacity);
         }
         _buffer = buffer;
         _capacity = that._size;
@@ -91,7 +100,9 @@ class Buffer {
     return *this;
   }
 
-  Buffer(Buffer&& that) noexcept : _buffer(_local), _capacity(sizeof(_local)) {
+  Buffer(Buffer&& that) noexcept
+      : _buffer(_local), _capacity(sizeof(_local)), _reallocations(that._reallocations),
+        _resource(that._resource) {
     poison(_buffer, _capacity);
     initWithNone();
     if (that._buffer == that._local) {
@@ -105,14 +116,16 @@ class Buffer {
     }
     _size = that._size;
     that._size = 0;
+    that._reallocations = 0;
     that.initWithNone();
   }
 
   Buffer& operator=(Buffer&& that) noexcept {
     if (this != &that) {
       if (_buffer != _local) {
-        velocypack_free(_buffer);
+        freeMemory(_buffer, _capacity);
       }
+      _resource = that._resource;
       if (that._buffer == that._local) {
         _buffer = _local;
         _capacity = sizeof(_local);
@@ -125,7 +138,9 @@ class Buffer {
         that._capacity = sizeof(that._local);
       }
       _size = that._size;
+      _reallocations = that._reallocations;
       that._size = 0;
+      that._reallocations = 0;
       that.initWithNone();
     }
     return *this;
@@ -133,7 +148,7 @@ class Buffer {
 
   ~Buffer() { 
     if (_buffer != _local) {
-      velocypack_free(_buffer);
+      freeMemory(_buffer, _capacity);
     }
   }
 
@@ -147,6 +162,14 @@ class Buffer {
   
   inline ValueLength capacity() const noexcept { return _capacity; }
 
+  // number of times the buffer had to be enlarged since it was created or
+  // last released its memory. each time, the contents are copied unless
+  // realloc can extend the memory in place
+  inline std::size_t reallocations() const noexcept { return _reallocations; }
+
+  // the MemoryResource the buffer allocates from (nullptr = default heap)
+  inline MemoryResource* resource() const noexcept { return _resource; }
+
   std::string toString() const {
     return std::string(reinterpret_cast<char const*>(_buffer), _size);
   }
@@ -184,8 +207,9 @@ class Buffer {
 
   void clear() noexcept {
     _size = 0;
+    _reallocations = 0;
     if (_buffer != _local) {
-      velocypack_free(_buffer);
+      freeMemory(_buffer, _capacity);
       _buffer = _local;
       _capacity = sizeof(_local);
       poison(_buffer, _capacity);
@@ -194,13 +218,18 @@ class Buffer {
   }
 
   // Steal external memory; only allowed when the buffer is not local,
-  // i.e. !usesLocalMemory()
-   T* steal() noexcept {
+  // i.e. !usesLocalMemory(), and when the memory comes from the default
+  // heap, i.e. resource() == nullptr, as the caller will release it with
+  // velocypack_free. Use stealChecked() if the buffer may use a
+  // MemoryResource
+  T* steal() noexcept {
     VELOCYPACK_ASSERT(!usesLocalMemory());
+    VELOCYPACK_ASSERT(_resource == nullptr);
 
     auto buffer = _buffer;
     _buffer = _local;
     _size = 0;
+    _reallocations = 0;
     _capacity = sizeof(_local);
     poison(_buffer, _capacity);
     initWithNone();
@@ -208,6 +237,15 @@ class Buffer {
     return buffer;
   }
 
+  // like steal(), but throws if the memory belongs to a MemoryResource
+  T* stealChecked() {
+    if (_resource != nullptr) {
+      throw Exception(Exception::InternalError,
+                      "Cannot steal memory of a MemoryResource");
+    }
+    return steal();
+  }
+
   inline T& operator[](std::size_t position) noexcept {
     return _buffer[position];
   }
@@ -280,6 +318,25 @@ class Buffer {
       throw std::bad_alloc();
     }
   }
+
+  T* allocateMemory(ValueLength len) {
+    T* p;
+    if (_resource == nullptr) {
+      p = static_cast<T*>(velocypack_malloc(checkOverflow(len)));
+    } else {
+      p = static_cast<T*>(_resource->allocate(checkOverflow(len), 1));
+    }
+    ensureValidPointer(p);
+    return p;
+  }
+
+  void freeMemory(T* p, ValueLength len) noexcept {
+    if (_resource == nullptr) {
+      velocypack_free(p);
+    } else {
+      _resource->deallocate(p, static_cast<std::size_t>(len), 1);
+    }
+  }
   
   // poison buffer memory, used only for debugging
 #ifdef VELOCYPACK_DEBUG
@@ -308,12 +365,16 @@ class Buffer {
     VELOCYPACK_ASSERT(newLen > 0);
     T* p;
     if (_buffer != _local) {
-      p = static_cast<T*>(velocypack_realloc(_buffer, checkOverflow(newLen)));
+      if (_resource == nullptr) {
+        p = static_cast<T*>(velocypack_realloc(_buffer, checkOverflow(newLen)));
+      } else {
+        p = static_cast<T*>(_resource->reallocate(
+            _buffer, checkOverflow(_capacity), checkOverflow(newLen), 1));
+      }
       ensureValidPointer(p);
       // realloc will have copied the old data
     } else {
-      p = static_cast<T*>(velocypack_malloc(checkOverflow(newLen)));
-      ensureValidPointer(p);
+      p = allocateMemory(newLen);
       // copy existing data into buffer
       memcpy(p, _buffer, checkOverflow(_size));
     }
@@ -321,6 +382,7 @@ class Buffer {
 
     _buffer = p;
     _capacity = newLen;
+    ++_reallocations;
     
     VELOCYPACK_ASSERT(_size <= _capacity);
   }
@@ -328,6 +390,8 @@ class Buffer {
   T* _buffer;
   ValueLength _capacity;
   ValueLength _size;
+  std::size_t _reallocations;
+  MemoryResource* _resource;
 
   // an already allocated space for small values
   T _local[192];
@@ -31,12 +31,14 @@
 #include <cstdint>
 #include <algorithm>
 #include <memory>
+#include <type_traits>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Basics.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Exception.h"
+#include "velocypack/MemoryResource.h"
 #include "velocypack/Options.h"
 #include "velocypack/Serializable.h"
 #include "velocypack/Slice.h"
@@ -53,6 +55,71 @@ namespace velocypack {
 class ArrayIterator;
 class ObjectIterator;
 
+// maps the C++ types accepted by the typed Builder::add overloads to
+// the type that is actually encoded. there is no "type" member for
+// other types, so these overloads do not take part in overload
+// resolution for them
+template <typename T, typename = void>
+struct BuilderScalar {};
+
+template <>
+struct BuilderScalar<bool> {
+  typedef bool type;
+  static type convert(bool v) noexcept { return v; }
+};
+
+template <typename T>
+struct BuilderScalar<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                std::is_signed<T>::value>::type> {
+  typedef int64_t type;
+  static type convert(T v) noexcept { return static_cast<int64_t>(v); }
+};
+
+template <typename T>
+struct BuilderScalar<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                std::is_unsigned<T>::value &&
+                                                !std::is_same<T, bool>::value>::type> {
+  typedef uint64_t type;
+  static type convert(T v) noexcept { return static_cast<uint64_t>(v); }
+};
+
+template <typename T>
+struct BuilderScalar<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  typedef double type;
+  static type convert(T v) noexcept { return static_cast<double>(v); }
+};
+
+template <>
+struct BuilderScalar<StringRef> {
+  typedef StringRef type;
+  static type convert(StringRef const& v) noexcept { return v; }
+};
+
+template <>
+struct BuilderScalar<std::string> {
+  typedef StringRef type;
+  static type convert(std::string const& v) noexcept { return StringRef(v); }
+};
+
+template <>
+struct BuilderScalar<char const*> {
+  typedef StringRef type;
+  static type convert(char const* v) noexcept { return StringRef(v); }
+};
+
+template <>
+struct BuilderScalar<char*> : BuilderScalar<char const*> {};
+
+#ifdef VELOCYPACK_HAS_STRING_VIEW
+template <>
+struct BuilderScalar<std::string_view> {
+  typedef StringRef type;
+  static type convert(std::string_view v) noexcept {
+    return StringRef(v.data(), v.size());
+  }
+};
+#endif
+
 class Builder {
   friend class Parser;  // The parser needs access to internals.
 
@@ -61,34 +128,61 @@ class Builder {
   // The variable _pos keeps the
   // current write position. The method "set" simply writes a new
   // VPack subobject at the current write position and advances
-  // it. Whenever one makes an array or object, a ValueLength for
+  // it. Whenever one makes an array or object, a CompoundInfo with
   // the beginning of the value is pushed onto the _stack, which
   // remembers that we are in the process of building an array or
-  // object. The _index vectors are used to collect information
-  // for the index tables of arrays and objects, which are written
-  // behind the subvalues. The add methods are used to keep track
-  // of the new subvalue in _index followed by a set, and are
-  // what the user from the outside calls. The close method seals
-  // the innermost array or object that is currently being built
-  // and pops a ValueLength off the _stack. The vectors in _index
-  // stay until the next clearTemporary() is called to minimize
-  // allocations. In the beginning, the _stack is empty, which
+  // object. The _indexes stack is used to collect the offsets of
+  // the subvalues for the index tables of arrays and objects, which
+  // are written behind the subvalues. It is shared by all open
+  // arrays and objects: each CompoundInfo remembers where the
+  // offsets of its own subvalues start. The add methods are used to
+  // keep track of the new subvalue in _indexes followed by a set, and
+  // are what the user from the outside calls. The close method seals
+  // the innermost array or object that is currently being built,
+  // drops its offsets from _indexes and pops its CompoundInfo off
+  // the _stack. Offsets are relative to the start of their array or
+  // object and are kept as 32 bit values; only if an array or object
+  // grows beyond 4 GB, all offsets are moved to _wideIndexes, which
+  // is then used until the next clear(). In the beginning, the
+  // _stack is empty, which
   // allows to build a sequence of unrelated VPack objects in the
   // buffer. Whenever the stack is empty, one can use the start,
   // size and slice methods to get out the ready built VPack
   // object(s).
 
  private:
+  // an open Array or Object
+  struct CompoundInfo {
+    CompoundInfo(ValueLength startPos, std::size_t indexStartPos,
+                 uint8_t headRoom) noexcept
+        : startPos(startPos), indexStartPos(indexStartPos), headRoom(headRoom) {}
+
+    ValueLength startPos;       // position of the head byte in the buffer
+    std::size_t indexStartPos;  // position of the first offset in the index stack
+    uint8_t headRoom;           // bytes reserved behind the head byte
+  };
+
+  // nesting depths for which the head room is predicted separately
+  static constexpr std::size_t headRoomDepths = 8;
+
   std::shared_ptr<Buffer<uint8_t>> _buffer;  // Here we collect the result
   Buffer<uint8_t>* _bufferPtr;      // used for quicker access than shared_ptr
   uint8_t* _start;                  // Always points to the start of _buffer
   ValueLength _pos;                 // the append position
-  std::vector<ValueLength> _stack;  // Start positions of
-                                    // open objects/arrays
-  std::vector<std::vector<ValueLength>> _index;  // Indices for starts
-                                                 // of subindex
+  std::vector<CompoundInfo, ResourceAllocator<CompoundInfo>> _stack;  // open objects/arrays
+  std::vector<uint32_t, ResourceAllocator<uint32_t>> _indexes;  // Offsets of the subvalues
+                                                                // of all open objects/arrays
+  std::vector<ValueLength, ResourceAllocator<ValueLength>> _wideIndexes;  // Same, once an
+                                                                          // offset needs 64 bits
+  bool _indexesAreWide;  // whether _wideIndexes is in use instead of _indexes
   bool _keyWritten;  // indicates that in the current object the key
                      // has been written but the value not yet
+  // head room needed by the last indexed Array or Object closed at each
+  // depth, used with PaddingBehavior::Adaptive
+  uint8_t _headRooms[headRoomDepths] = {8, 8, 8, 8, 8, 8, 8, 8};
+  ValueLength _memmoveBytes = 0;         // bytes moved down or up by close()
+  ValueLength _memmoveBytesAvoided = 0;  // bytes close() did not have to move
+                                         // thanks to a smaller head room
 
  public:
   Options const* options;
@@ -105,6 +199,12 @@ class Builder {
   explicit Builder(Buffer<uint8_t>& buffer,
                    Options const* options = &Options::Defaults);
 
+  // create an empty Builder that allocates its Buffer and all of its
+  // bookkeeping from the resource, which must outlive the Builder and
+  // everything stolen from it. copies of the Builder use the default heap
+  explicit Builder(MemoryResource& resource,
+                   Options const* options = &Options::Defaults);
+
   // populate a Builder from a Slice
   explicit Builder(Slice slice, Options const* options = &Options::Defaults);
 
@@ -185,7 +285,9 @@ class Builder {
   void clear() noexcept {
     _pos = 0;
     _stack.clear();
-    _index.clear();
+    _indexes.clear();
+    _wideIndexes.clear();
+    _indexesAreWide = false;
     if (_bufferPtr != nullptr) {
       _bufferPtr->reset();
       _start = _bufferPtr->data();
@@ -261,7 +363,7 @@ class Builder {
     if (_stack.empty()) {
       return false;
     }
-    ValueLength const tos = _stack.back();
+    ValueLength const tos = _stack.back().startPos;
     return _start[tos] == 0x06 || _start[tos] == 0x13;
   }
 
@@ -269,7 +371,7 @@ class Builder {
     if (_stack.empty()) {
       return false;
     }
-    ValueLength const tos = _stack.back();
+    ValueLength const tos = _stack.back().startPos;
     return _start[tos] == 0x0b || _start[tos] == 0x14;
   }
 
@@ -281,6 +383,28 @@ class Builder {
     openCompoundValue(unindexed ? 0x14 : 0x0b);
   }
 
+  // open an Array or Object whose byte size is expected to be about
+  // sizeHint. this reserves just enough room for its header, so that
+  // close() does not have to move its members if the hint is right.
+  // the hint is ignored with PaddingBehavior::UsePadding
+  inline void openArray(bool unindexed, ValueLength sizeHint) {
+    openCompoundValue(unindexed ? 0x13 : 0x06, sizeHint);
+  }
+
+  inline void openObject(bool unindexed, ValueLength sizeHint) {
+    openCompoundValue(unindexed ? 0x14 : 0x0b, sizeHint);
+  }
+
+  // number of bytes moved by close() so far, to make room for or get
+  // rid of unused header bytes
+  ValueLength memmoveBytes() const noexcept { return _memmoveBytes; }
+
+  // number of bytes close() did not have to move so far, because an
+  // Array or Object was opened with a fitting head room
+  ValueLength memmoveBytesAvoided() const noexcept {
+    return _memmoveBytesAvoided;
+  }
+
   template <typename T>
   uint8_t* addUnchecked(char const* attrName, std::size_t attrLength, T const& sub) {
     bool haveReported = false;
@@ -378,6 +502,31 @@ class Builder {
     return addInternal<Serializable>(0, sub._sable);
   }
 
+  // Add a bool, number or string into an array, without going through
+  // a Value. Integers are stored as Int or UInt depending on the
+  // signedness of their type, strings as String:
+  template <typename T, typename S = typename BuilderScalar<typename std::decay<T>::type>::type>
+  inline uint8_t* add(T const& sub) {
+    return addInternal<S>(0, BuilderScalar<typename std::decay<T>::type>::convert(sub));
+  }
+
+  // Add a bool, number or string into an object, without going through
+  // a Value:
+  template <typename T, typename S = typename BuilderScalar<typename std::decay<T>::type>::type>
+  inline uint8_t* add(std::string const& attrName, T const& sub) {
+    return addInternal<S>(attrName, 0, BuilderScalar<typename std::decay<T>::type>::convert(sub));
+  }
+
+  template <typename T, typename S = typename BuilderScalar<typename std::decay<T>::type>::type>
+  inline uint8_t* add(StringRef const& attrName, T const& sub) {
+    return addInternal<S>(attrName, 0, BuilderScalar<typename std::decay<T>::type>::convert(sub));
+  }
+
+  template <typename T, typename S = typename BuilderScalar<typename std::decay<T>::type>::type>
+  inline uint8_t* add(char const* attrName, T const& sub) {
+    return addInternal<S>(attrName, 0, BuilderScalar<typename std::decay<T>::type>::convert(sub));
+  }
+
   // Add a subvalue into an object from a Value:
   inline uint8_t* addTagged(std::string const& attrName, uint64_t tag, Value const& sub) {
     return addInternal<Value>(attrName, tag, sub);
@@ -513,8 +662,36 @@ class Builder {
     return add(std::move(sub));
   }
 
+  // Add n values to an open array, reserving the memory for all of them
+  // at once
+  uint8_t* addSlices(Slice const* slices, std::size_t n);
+
+  // Add the consecutive values in data to an open array with a single
+  // copy, e.g. the contents of another Builder that holds several
+  // values at its top level
+  uint8_t* addSequence(uint8_t const* data, ValueLength size);
+
+  // Add n values with the given byte sizes to an open array, without
+  // writing them. Returns a pointer to the first one, each following one
+  // starts right behind its predecessor. The values can be written
+  // independently, e.g. by several threads, but must all be written
+  // before the Builder is used again. The pointer is invalidated by
+  // anything that can grow the Builder
+  uint8_t* addUninitialized(ValueLength const* sizes, std::size_t n);
+
   // Seal the innermost array or object:
-  Builder& close();
+  Builder& close() {
+    return close(true);
+  }
+
+  // Seal the innermost array or object. The caller guarantees that the
+  // members of an object were added in sorted key order, so that its
+  // index table does not need to be sorted. This is not checked except
+  // by an assertion in debug builds: unsorted keys produce an object
+  // whose binary search misses attributes:
+  Builder& closePresorted() {
+    return close(false);
+  }
 
   // whether or not a specific key is present in an Object value
   bool hasKey(std::string const& key) const;
@@ -565,30 +742,72 @@ class Builder {
   }
 
  private:
-  void sortObjectIndexShort(uint8_t* objBase,
-                            std::vector<ValueLength>& offsets) const;
+  // the following are instantiated for uint32_t and ValueLength offsets
+  template <typename T>
+  void sortObjectIndexShort(uint8_t* objBase, T* offsets, std::size_t n) const;
 
-  void sortObjectIndexLong(uint8_t* objBase,
-                           std::vector<ValueLength>& offsets);
+  template <typename T>
+  void sortObjectIndexLong(uint8_t* objBase, T* offsets, std::size_t n);
 
-  void sortObjectIndex(uint8_t* objBase,
-                       std::vector<ValueLength>& offsets) {
-    if (offsets.size() > 32) {
-      sortObjectIndexLong(objBase, offsets);
-    } else {
-      sortObjectIndexShort(objBase, offsets);
-    }
-  }
+  template <typename T>
+  void sortObjectIndex(uint8_t* objBase, T* offsets, std::size_t n);
+
+  Builder& close(bool sortIndex);
+
+  template <typename T>
+  Builder& closeCompound(T* index, std::size_t n, bool sortIndex);
 
   // close for the empty case:
   Builder& closeEmptyArrayOrObject(ValueLength tos, bool isArray);
 
   // close for the compact case:
-  bool closeCompactArrayOrObject(ValueLength tos, bool isArray,
-                                 std::vector<ValueLength> const& index);
+  bool closeCompactArrayOrObject(ValueLength tos, bool isArray, std::size_t n);
 
   // close for the array case:
-  Builder& closeArray(ValueLength tos, std::vector<ValueLength>& index);
+  template <typename T>
+  Builder& closeArray(ValueLength tos, T* index, std::size_t n);
+
+  // close an Array or Object that was opened with less than 8 bytes of
+  // head room, moving its members down at most. returns false if its
+  // header does not fit
+  template <typename T>
+  bool closeInHeadRoom(ValueLength tos, T* index, std::size_t n,
+                       bool compact, bool sortIndex);
+
+  // move the members of the innermost Array or Object down by diff
+  // bytes of its head room
+  void moveDown(ValueLength tos, ValueLength diff);
+
+  // move the members of the innermost Array or Object up, so that it
+  // has the full 8 bytes of head room
+  template <typename T>
+  void growHeadRoom(ValueLength tos, T* index, std::size_t n);
+
+  // remember the head room the innermost Array or Object needed
+  inline void learnHeadRoom(ValueLength headRoom) noexcept {
+    _headRooms[(std::min)(_stack.size() - 1, headRoomDepths - 1)] =
+        static_cast<uint8_t>((std::min)(headRoom, static_cast<ValueLength>(8)));
+  }
+
+  // number of offsets on the index stack
+  inline std::size_t indexesSize() const noexcept {
+    return _indexesAreWide ? _wideIndexes.size() : _indexes.size();
+  }
+
+  inline ValueLength indexAt(std::size_t position) const noexcept {
+    return _indexesAreWide ? _wideIndexes[position] : _indexes[position];
+  }
+
+  // drop the innermost open Array or Object and its offsets
+  inline void popCompound() noexcept {
+    std::size_t const indexStartPos = _stack.back().indexStartPos;
+    if (VELOCYPACK_LIKELY(!_indexesAreWide)) {
+      _indexes.resize(indexStartPos);
+    } else {
+      _wideIndexes.resize(indexStartPos);
+    }
+    _stack.pop_back();
+  }
 
   void addNull() {
     appendByte(0x18);
@@ -687,7 +906,7 @@ class Builder {
 
   inline void checkKeyIsString(bool isString) {
     if (!_stack.empty()) {
-      ValueLength const& tos = _stack.back();
+      ValueLength const tos = _stack.back().startPos;
       if (_start[tos] == 0x0b || _start[tos] == 0x14) {
         if (VELOCYPACK_UNLIKELY(!_keyWritten && !isString)) {
           throw Exception(Exception::BuilderKeyMustBeString);
@@ -699,7 +918,7 @@ class Builder {
 
   inline void checkKeyIsString(Slice const& item) {
     if (!_stack.empty()) {
-      ValueLength const& tos = _stack.back();
+      ValueLength const tos = _stack.back().startPos;
       if (_start[tos] == 0x0b || _start[tos] == 0x14) {
         if (VELOCYPACK_UNLIKELY(!_keyWritten && !item.isString())) {
           throw Exception(Exception::BuilderKeyMustBeString);
@@ -756,7 +975,7 @@ class Builder {
   uint8_t* addInternal(char const* attrName, std::size_t attrLength, uint64_t tag, T const& sub) {
     bool haveReported = false;
     if (!_stack.empty()) {
-      ValueLength const to = _stack.back();
+      ValueLength const to = _stack.back().startPos;
       if (VELOCYPACK_UNLIKELY(_start[to] != 0x0b && _start[to] != 0x14)) {
         throw Exception(Exception::BuilderNeedOpenObject);
       }
@@ -798,23 +1017,51 @@ class Builder {
     }
   }
 
-  void addCompoundValue(uint8_t type) {
+  void addCompoundValue(uint8_t type, ValueLength sizeHint = 0) {
+    uint8_t const headRoom = compoundHeadRoom(type, sizeHint);
     reserve(9);
     // an Array or Object is started:
-    _stack.push_back(_pos);
-    while (_stack.size() > _index.size()) {
-      _index.emplace_back();
-    }
-    _index[_stack.size() - 1].clear();
+    _stack.emplace_back(_pos, indexesSize(), headRoom);
     appendByteUnchecked(type);
     memset(_start + _pos, 0, 8);
-    advance(8);  // Will be filled later with bytelength and nr subs
+    advance(headRoom);  // Will be filled later with bytelength and nr subs
   }
 
-  void openCompoundValue(uint8_t type) {
+  // bytes to reserve for the header of an Array or Object behind its
+  // head byte. 8 bytes fit every header
+  uint8_t compoundHeadRoom(uint8_t type, ValueLength sizeHint) const noexcept {
+    bool const indexed = (type == 0x06 || type == 0x0b);
+    if (options->paddingBehavior == Options::PaddingBehavior::UsePadding) {
+      // headers are padded to 8 bytes anyway
+      return 8;
+    }
+    uint8_t headRoom;
+    if (sizeHint != 0) {
+      if (indexed) {
+        return sizeHint <= 0xff ? 2 : (sizeHint <= 0xffff ? 4 : 8);
+      }
+      headRoom = static_cast<uint8_t>((std::min)(
+          getVariableValueLength(sizeHint), static_cast<ValueLength>(8)));
+    } else if (indexed &&
+               options->paddingBehavior == Options::PaddingBehavior::Adaptive) {
+      // only indexed headers are predicted. the byte length of a compact
+      // one must be minimal, so a wrong guess would always cost a move
+      headRoom = _headRooms[(std::min)(_stack.size(), headRoomDepths - 1)];
+    } else {
+      return 8;
+    }
+    if (indexed) {
+      // the header of an indexed Array or Object is 2, 3, 5 or 9 bytes
+      // long
+      headRoom = headRoom <= 2 ? headRoom : (headRoom <= 4 ? 4 : 8);
+    }
+    return headRoom;
+  }
+
+  void openCompoundValue(uint8_t type, ValueLength sizeHint = 0) {
     bool haveReported = false;
     if (!_stack.empty()) {
-      ValueLength const to = _stack.back();
+      ValueLength const to = _stack.back().startPos;
       if (!_keyWritten) {
         if (VELOCYPACK_UNLIKELY(_start[to] != 0x06 && _start[to] != 0x13)) {
           throw Exception(Exception::BuilderNeedOpenArray);
@@ -826,7 +1073,7 @@ class Builder {
       }
     }
     try {
-      addCompoundValue(type);
+      addCompoundValue(type, sizeHint);
     } catch (...) {
       // clean up in case of an exception
       if (haveReported) {
@@ -869,22 +1116,88 @@ class Builder {
     return set(0, sable);
   }
 
+  // the following are used by the typed add overloads
+  uint8_t* set(uint64_t tag, bool value) {
+    auto const oldPos = _pos;
+    checkKeyIsString(false);
+    if (tag != 0) {
+      appendTag(tag);
+    }
+    appendByte(value ? 0x1a : 0x19);
+    return _start + oldPos;
+  }
+
+  uint8_t* set(uint64_t tag, int64_t value) {
+    auto const oldPos = _pos;
+    checkKeyIsString(false);
+    if (tag != 0) {
+      appendTag(tag);
+    }
+    addInt(value);
+    return _start + oldPos;
+  }
+
+  uint8_t* set(uint64_t tag, uint64_t value) {
+    auto const oldPos = _pos;
+    checkKeyIsString(false);
+    if (tag != 0) {
+      appendTag(tag);
+    }
+    addUInt(value);
+    return _start + oldPos;
+  }
+
+  uint8_t* set(uint64_t tag, double value) {
+    auto const oldPos = _pos;
+    checkKeyIsString(false);
+    if (tag != 0) {
+      appendTag(tag);
+    }
+    addDouble(value);
+    return _start + oldPos;
+  }
+
+  uint8_t* set(uint64_t tag, StringRef const& value) {
+    auto const oldPos = _pos;
+    checkKeyIsString(true);
+    if (tag != 0) {
+      appendTag(tag);
+    }
+    appendString(value.data(), value.size());
+    return _start + oldPos;
+  }
+
   void cleanupAdd() noexcept {
-    std::size_t depth = _stack.size() - 1;
-    VELOCYPACK_ASSERT(!_index[depth].empty());
-    _index[depth].pop_back();
+    VELOCYPACK_ASSERT(indexesSize() > _stack.back().indexStartPos);
+    if (VELOCYPACK_LIKELY(!_indexesAreWide)) {
+      _indexes.pop_back();
+    } else {
+      _wideIndexes.pop_back();
+    }
   }
 
   inline void reportAdd() {
-    std::size_t depth = _stack.size() - 1;
-    ValueLength pos = _pos - _stack[depth];
+    CompoundInfo const& tos = _stack.back();
+    ValueLength const pos = _pos - tos.startPos;
 
+    if (VELOCYPACK_UNLIKELY(_indexesAreWide || pos > 0xffffffffu)) {
+      reportAddWide(pos);
+      return;
+    }
     // avoid same position being added several times
-    if(_index[depth].empty() || _index[depth].back() != pos) {
-      _index[depth].push_back(pos);
+    if (_indexes.size() == tos.indexStartPos || _indexes.back() != pos) {
+      _indexes.push_back(static_cast<uint32_t>(pos));
     }
   }
 
+  // reportAdd() for offsets that do not fit into 32 bits
+  void reportAddWide(ValueLength pos);
+
+  // keep all offsets as 64 bit values from now on
+  void makeIndexesWide();
+
+  void checkOpenArray() const;
+
   template <uint64_t n>
   void appendLengthUnchecked(ValueLength v) {
     for (uint64_t i = 0; i < n; ++i) {
@@ -893,51 +1206,62 @@ class Builder {
     }
   }
 
+  // returns the number of significant bits in value, at least 1
+  static inline uint8_t significantBits(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint8_t>(64 - __builtin_clzll(value | 1));
+#else
+    uint8_t bits = 1;
+    while ((value >>= 1) != 0) {
+      ++bits;
+    }
+    return bits;
+#endif
+  }
+
+  // returns number of bytes required to store the value unsigned
+  static inline uint8_t uintLength(uint64_t value) noexcept {
+    return static_cast<uint8_t>((significantBits(value) + 7) / 8);
+  }
+
   void appendUInt(uint64_t v, uint8_t base) {
+    uint8_t const vSize = uintLength(v);
     reserve(9);
-    ValueLength save = _pos;
-    advance(1);
-    uint8_t vSize = 0;
-    do {
-      vSize++;
-      appendByteUnchecked(static_cast<uint8_t>(v & 0xff));
-      v >>= 8;
-    } while (v != 0);
-    _start[save] = base + vSize;
+    _start[_pos] = base + vSize;
+    // writes all 8 bytes, but only the significant ones are kept
+    storeUInt64(_start + _pos + 1, v);
+    advance(1 + vSize);
   }
 
   // returns number of bytes required to store the value in 2s-complement
-  static inline uint8_t intLength(int64_t value) {
-    if (value >= -0x80 && value <= 0x7f) {
-      // shortcut for the common case
-      return 1;
-    }
-    uint64_t x = value >= 0 ? static_cast<uint64_t>(value)
-                            : static_cast<uint64_t>(-(value + 1));
-    uint8_t xSize = 0;
-    do {
-      xSize++;
-      x >>= 8;
-    } while (x >= 0x80);
-    return xSize + 1;
+  static inline uint8_t intLength(int64_t value) noexcept {
+    // the bits of the magnitude plus one sign bit
+    uint64_t const x = value < 0 ? ~toUInt64(value) : toUInt64(value);
+    return static_cast<uint8_t>((significantBits(x) + 8) / 8);
   }
 
   void appendInt(int64_t v, uint8_t base) {
-    uint8_t vSize = intLength(v);
-    uint64_t x;
-    if (vSize == 8) {
-      x = toUInt64(v);
+    uint8_t const vSize = intLength(v);
+    reserve(9);
+    _start[_pos] = base + vSize;
+    // the low vSize bytes of the 2s-complement are the encoded value
+    storeUInt64(_start + _pos + 1, toUInt64(v));
+    advance(1 + vSize);
+  }
+
+  void appendString(char const* p, std::size_t size) {
+    if (size <= 126) {
+      // short string
+      reserve(1 + size);
+      appendByteUnchecked(static_cast<uint8_t>(0x40 + size));
     } else {
-      int64_t shift = 1LL << (vSize * 8 - 1);  // will never overflow!
-      x = v >= 0 ? static_cast<uint64_t>(v)
-                 : static_cast<uint64_t>(v + shift) + shift;
-    }
-    reserve(1 + vSize);
-    appendByteUnchecked(base + vSize);
-    while (vSize-- > 0) {
-      appendByteUnchecked(x & 0xff);
-      x >>= 8;
+      // long string
+      reserve(1 + 8 + size);
+      appendByteUnchecked(0xbf);
+      appendLengthUnchecked<8>(size);
     }
+    memcpy(_start + _pos, p, size);
+    advance(size);
   }
 
   inline void appendByte(uint8_t value) {
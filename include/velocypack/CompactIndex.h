@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_COMPACTINDEX_H
+#define VELOCYPACK_COMPACTINDEX_H 1
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+class CompactIndex {
+  // A caller-owned index for a compact Array (0x13) or Object (0x14),
+  // which have no index table of their own, so that Slice::at() and
+  // friends walk all members before the one asked for. The offsets of
+  // the members are collected on the first access to a container, and
+  // every later access by position takes constant time. Lookups by
+  // attribute name also hash all keys on first use. Other Arrays and
+  // Objects are passed through to Slice.
+  // The index refers to the memory of the container it was built for.
+  // It remembers the address, head byte, byte size and number of members
+  // of that container, and is rebuilt whenever a container that differs
+  // in any of these is passed, e.g. after a Builder or Parser reused its
+  // buffer. Reading these takes constant time. Only a different container
+  // that matches in all of them goes unnoticed, so call clear() when
+  // writing values of the same size into the same memory. A CompactIndex
+  // must not be shared between threads.
+
+ public:
+  CompactIndex();
+
+  CompactIndex(CompactIndex const&) = delete;
+  CompactIndex& operator=(CompactIndex const&) = delete;
+
+  // extract the nth member from an Array
+  Slice at(Slice array, ValueLength index);
+
+  // extract the key of the nth member from an Object
+  Slice keyAt(Slice object, ValueLength index, bool translate = true);
+
+  // extract the value of the nth member from an Object
+  Slice valueAt(Slice object, ValueLength index);
+
+  // look for the specified attribute inside an Object
+  // returns a Slice(ValueType::None) if not found
+  Slice get(Slice object, StringRef const& attribute);
+
+  Slice get(Slice object, std::string const& attribute) {
+    return get(object, StringRef(attribute.data(), attribute.size()));
+  }
+
+  Slice get(Slice object, char const* attribute) {
+    return get(object, StringRef(attribute));
+  }
+
+  // forget the container the index was built for
+  void clear() noexcept;
+
+ private:
+  // collects the member offsets of a compact container, unless this
+  // was done already
+  void build(Slice container);
+
+  // returns the offset of the nth member of the indexed container
+  ValueLength offset(ValueLength index) const;
+
+ private:
+  uint8_t const* _start;            // the indexed container, or nullptr
+  ValueLength _byteSize;            // of the indexed container
+  uint8_t _head;                    // of the indexed container
+  std::vector<ValueLength> _offsets;  // of members, or keys in Objects
+  std::unordered_map<StringRef, ValueLength> _keys;  // key -> position
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -72,7 +72,8 @@ class HashedStringRef {
     : HashedStringRef(data, strlen(data)) {}
 #endif
    
-  /// @brief create a HashedStringRef from a VPack slice (must be of type String)
+  /// @brief create a HashedStringRef from a VPack slice (must be of type String, or an
+  /// External pointing to one, as from Parser::parseInSitu())
   explicit HashedStringRef(Slice slice);
   
   /// @brief create a HashedStringRef from anther StringRef
@@ -122,7 +123,8 @@ class HashedStringRef {
     return *this;
   }
   
-  /// @brief create a HashedStringRef from a VPack slice of type String
+  /// @brief create a HashedStringRef from a VPack slice of type String, or an
+  /// External pointing to one
   HashedStringRef& operator=(Slice slice);
   
   /// @brief create a HashedStringRef from a StringRef
@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_MEMORYRESOURCE_H
+#define VELOCYPACK_MEMORYRESOURCE_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "velocypack/velocypack-common.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// source of memory for Buffers and Builders. Objects that accept a
+// MemoryResource pointer treat a nullptr as "use the default heap", so
+// the default code paths do not pay for a virtual call.
+// Implementations must throw std::bad_alloc if they cannot satisfy a
+// request.
+class MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+
+  virtual void* allocate(std::size_t size, std::size_t alignment) = 0;
+
+  virtual void deallocate(void* p, std::size_t size,
+                          std::size_t alignment) noexcept = 0;
+
+  // grows or shrinks a block returned by allocate(). the first
+  // min(oldSize, newSize) bytes are preserved. the default implementation
+  // allocates a new block, copies and deallocates the old one
+  virtual void* reallocate(void* p, std::size_t oldSize, std::size_t newSize,
+                           std::size_t alignment);
+};
+
+// monotonic arena: allocations are carved out of large blocks by bumping
+// a pointer, and deallocate() is a no-op. All memory is handed back at
+// once by release(), which keeps the most recent block around so that
+// an arena that is reused for many requests reaches a steady state in
+// which neither allocating nor releasing touches the heap.
+// An ArenaMemoryResource is not thread-safe; use one per thread or per
+// request. Everything allocated from it must be destroyed (or abandoned)
+// before release() is called.
+class ArenaMemoryResource final : public MemoryResource {
+ public:
+  static constexpr std::size_t defaultBlockSize = 4096;
+
+  explicit ArenaMemoryResource(std::size_t blockSize = defaultBlockSize);
+
+  // use the caller-provided memory (e.g. a stack buffer) before falling
+  // back to heap blocks. the memory is not owned by the arena
+  ArenaMemoryResource(void* buffer, std::size_t size,
+                      std::size_t blockSize = defaultBlockSize);
+
+  ~ArenaMemoryResource();
+
+  ArenaMemoryResource(ArenaMemoryResource const&) = delete;
+  ArenaMemoryResource& operator=(ArenaMemoryResource const&) = delete;
+
+  void* allocate(std::size_t size, std::size_t alignment) override;
+
+  void deallocate(void*, std::size_t, std::size_t) noexcept override {}
+
+  // extends the most recent allocation in place if there is room for it
+  void* reallocate(void* p, std::size_t oldSize, std::size_t newSize,
+                   std::size_t alignment) override;
+
+  // hands back all memory allocated from the arena
+  void release() noexcept;
+
+  // number of bytes handed out since construction or the last release()
+  std::size_t allocatedBytes() const noexcept { return _allocated; }
+
+  // number of heap blocks currently owned by the arena
+  std::size_t blocks() const noexcept { return _blocks; }
+
+ private:
+  struct Block {
+    Block* next;
+    std::size_t size;
+  };
+
+  void addBlock(std::size_t minSize);
+
+  void resetTo(uint8_t* begin, uint8_t* end) noexcept {
+    _current = begin;
+    _end = end;
+    _last = nullptr;
+  }
+
+  uint8_t* _current;     // next free byte in the current region
+  uint8_t* _end;         // end of the current region
+  uint8_t* _last;        // start of the most recent allocation
+  Block* _head;          // most recent heap block, linked to older ones
+  uint8_t* _initial;     // caller-provided memory, may be nullptr
+  std::size_t _initialSize;
+  std::size_t _blockSize;
+  std::size_t _nextBlockSize;
+  std::size_t _allocated;
+  std::size_t _blocks;
+};
+
+// STL allocator that draws its memory from a MemoryResource, or from
+// the default heap if the resource is a nullptr. Containers moved from
+// take their resource with them, while copies of a container always use
+// the default heap, so that a copy can safely outlive the resource.
+template <typename T>
+class ResourceAllocator {
+ public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  ResourceAllocator() noexcept : _resource(nullptr) {}
+
+  explicit ResourceAllocator(MemoryResource* resource) noexcept
+      : _resource(resource) {}
+
+  template <typename U>
+  ResourceAllocator(ResourceAllocator<U> const& other) noexcept
+      : _resource(other.resource()) {}
+
+  T* allocate(std::size_t n) {
+    if (_resource == nullptr) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    if (_resource == nullptr) {
+      ::operator delete(p);
+    } else {
+      _resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+  }
+
+  ResourceAllocator select_on_container_copy_construction() const noexcept {
+    return ResourceAllocator();
+  }
+
+  MemoryResource* resource() const noexcept { return _resource; }
+
+ private:
+  MemoryResource* _resource;
+};
+
+template <typename T, typename U>
+inline bool operator==(ResourceAllocator<T> const& lhs,
+                       ResourceAllocator<U> const& rhs) noexcept {
+  return lhs.resource() == rhs.resource();
+}
+
+template <typename T, typename U>
+inline bool operator!=(ResourceAllocator<T> const& lhs,
+                       ResourceAllocator<U> const& rhs) noexcept {
+  return lhs.resource() != rhs.resource();
+}
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -34,6 +34,7 @@ namespace velocypack {
 class AttributeTranslator;
 class Dumper;
 struct Options;
+class Projection;
 class Slice;
 
 struct CustomTypeHandler {
@@ -66,7 +67,13 @@ struct Options {
     NoPadding,
     // pad in cases the Builder considers it useful, and don't pad in other
     // cases when the Builder doesn't consider it useful
-    Flexible
+    Flexible,
+    // reserve as many head bytes as the last indexed Array/Object closed
+    // at the same nesting depth needed, so that the data usually stays
+    // where it is. move the data if the header needs a different size.
+    // compact Arrays/Objects always get the minimal header, and are not
+    // learned from
+    Adaptive
   };
 
   Options() {}
@@ -84,6 +91,10 @@ struct Options {
   // custom type handler used for processing custom types by Dumper and Slicer
   CustomTypeHandler* customTypeHandler = nullptr;
 
+  // attribute paths to keep when JSON-parsing with Parser. if set, the
+  // Parser builds an Object with only these paths and skips everything else
+  Projection const* projection = nullptr;
+
   // allow building Arrays without index table?
   bool buildUnindexedArrays = false;
 
@@ -105,6 +116,10 @@ struct Options {
   // validate UTF-8 strings when JSON-parsing with Parser
   bool validateUtf8Strings = false;
 
+  // minimum length of strings that Parser::parseInSitu() leaves in the
+  // JSON input and references via External values instead of copying
+  ValueLength inSituStringMinLength = 256;
+
   // validate that attribute names in Object values are actually
   // unique when creating objects via Builder. This also includes
   // creation of Object values via a Parser
@@ -27,8 +27,11 @@
 
 #include <string>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Exception.h"
 #include "velocypack/Options.h"
@@ -41,38 +44,45 @@ class Parser {
   // blocks of memory. It builds the result using the Builder.
 
   struct ParsedNumber {
-    ParsedNumber() : intValue(0), doubleValue(0.0), isInteger(true) {}
+    ParsedNumber()
+        : mantissa(0), exponent(0), isInteger(true), truncated(false) {}
 
+    // adds a digit of the integral part
     void addDigit(int i) {
       if (isInteger) {
         // check if adding another digit to the int will make it overflow
-        if (intValue < 1844674407370955161ULL ||
-            (intValue == 1844674407370955161ULL && (i - '0') <= 5)) {
+        if (mantissa < 1844674407370955161ULL ||
+            (mantissa == 1844674407370955161ULL && (i - '0') <= 5)) {
           // int won't overflow
-          intValue = intValue * 10 + (i - '0');
+          mantissa = mantissa * 10 + (i - '0');
           return;
         }
-        // int would overflow
-        doubleValue = static_cast<double>(intValue);
+        // int would overflow. keep the leading digits as the mantissa
         isInteger = false;
       }
-
-      doubleValue = doubleValue * 10.0 + (i - '0');
-      if (std::isnan(doubleValue) || !std::isfinite(doubleValue)) {
-        throw Exception(Exception::NumberOutOfRange);
+      ++exponent;
+      if (i != '0') {
+        truncated = true;
       }
     }
 
-    double asDouble() const {
-      if (isInteger) {
-        return static_cast<double>(intValue);
+    // adds a digit of the fractional part. at most 19 significant digits
+    // are kept in the mantissa, the remaining ones are only recorded
+    void addFractionalDigit(int i) {
+      if (mantissa < 1000000000000000000ULL) {
+        mantissa = mantissa * 10 + (i - '0');
+        --exponent;
+      } else if (i != '0') {
+        truncated = true;
       }
-      return doubleValue;
     }
 
-    uint64_t intValue;
-    double doubleValue;
+    // the value is mantissa * 10^exponent. if truncated is set, some
+    // non-zero digits did not fit into the mantissa
+    uint64_t mantissa;
+    int64_t exponent;
     bool isInteger;
+    bool truncated;
   };
 
   std::shared_ptr<Builder> _builder;
@@ -82,6 +92,34 @@ class Parser {
   std::size_t _pos;
   int _nesting;
 
+  // state of an incremental parse via feed() and finish()
+  enum class StreamState : uint8_t {
+    Idle,        // no incremental parse in progress
+    Value,       // expecting a value
+    ValueOrEnd,  // expecting a value or ']' (after '[')
+    KeyOrEnd,    // expecting an attribute name or '}' (after '{')
+    Key,         // expecting an attribute name (after ',' in an object)
+    Colon,       // expecting ':'
+    CommaOrEnd,  // expecting ',' or the end of the current compound value
+    Done         // top-level value complete, only whitespace may follow
+  };
+  StreamState _streamState;
+  // types of the currently open compound values, '[' or '{'
+  std::vector<uint8_t> _streamStack;
+  // start of a token that was cut off at the end of the previous chunk
+  Buffer<uint8_t> _carry;
+  // whether the last byte in _carry is an escaping backslash
+  bool _carryEscaped;
+  // Builder position of the attribute name being parsed
+  ValueLength _streamKeyPos;
+  // whether the top-level value was reported to an open Array in the
+  // Builder and is not complete yet
+  bool _streamReported;
+  // writable input during parseInSitu(), nullptr otherwise
+  uint8_t* _inSitu;
+  // input bytes before this position may be referenced by Externals
+  std::size_t _inSituFree;
+
  public:
   Options const* options;
 
@@ -96,6 +134,12 @@ class Parser {
         _size(0), 
         _pos(0), 
         _nesting(0), 
+        _streamState(StreamState::Idle),
+        _carryEscaped(false),
+        _streamKeyPos(0),
+        _streamReported(false),
+        _inSitu(nullptr),
+        _inSituFree(0),
         options(&Options::Defaults) {
     _builder.reset(new Builder());
     _builderPtr = _builder.get();
@@ -107,6 +151,12 @@ class Parser {
         _size(0), 
         _pos(0), 
         _nesting(0), 
+        _streamState(StreamState::Idle),
+        _carryEscaped(false),
+        _streamKeyPos(0),
+        _streamReported(false),
+        _inSitu(nullptr),
+        _inSituFree(0),
         options(options) {
     if (VELOCYPACK_UNLIKELY(options == nullptr)) {
       throw Exception(Exception::InternalError, "Options cannot be a nullptr");
@@ -124,6 +174,12 @@ class Parser {
         _size(0), 
         _pos(0), 
         _nesting(0),
+        _streamState(StreamState::Idle),
+        _carryEscaped(false),
+        _streamKeyPos(0),
+        _streamReported(false),
+        _inSitu(nullptr),
+        _inSituFree(0),
          options(options) {
     if (VELOCYPACK_UNLIKELY(options == nullptr)) {
       throw Exception(Exception::InternalError, "Options cannot be a nullptr");
@@ -137,6 +193,12 @@ class Parser {
         _size(0), 
         _pos(0), 
         _nesting(0),
+        _streamState(StreamState::Idle),
+        _carryEscaped(false),
+        _streamKeyPos(0),
+        _streamReported(false),
+        _inSitu(nullptr),
+        _inSituFree(0),
          options(options) {
     if (VELOCYPACK_UNLIKELY(options == nullptr)) {
       throw Exception(Exception::InternalError, "Options cannot be a nullptr");
@@ -190,8 +252,46 @@ class Parser {
     return parseInternal(multi);
   }
 
-  // We probably want a parse from stream at some stage...
-  // Not with this high-performance two-pass approach. :-(
+  // Parses like parse(), but strings without escape sequences that are
+  // at least options->inSituStringMinLength bytes long are not copied.
+  // Instead, the String header is written into the already parsed input
+  // bytes right in front of the string, and the Builder gets an External
+  // value pointing there. The input is modified and must outlive the
+  // Builder and all copies of its Externals. Strings that have not enough
+  // free bytes in front of them are copied as usual. Attribute names are
+  // always copied.
+  // The string accessors of Slice (copyString(), stringRef(), toString(),
+  // isEqualString() etc.) and the Dumper resolve such Externals. The type
+  // checks do not: type() is ValueType::External and isString() is false
+  // for a referenced string. Callers that branch on the type of a value
+  // must check resolveExternal().isString() instead of isString().
+  ValueLength parseInSitu(uint8_t* start, std::size_t size, bool multi = false);
+
+  ValueLength parseInSitu(char* start, std::size_t size, bool multi = false) {
+    return parseInSitu(reinterpret_cast<uint8_t*>(start), size, multi);
+  }
+
+  // Incremental parsing of a single JSON value that arrives in chunks.
+  // Each chunk is parsed as far as possible and written into the Builder
+  // right away, so the chunk does not need to stay valid after feed()
+  // returns. Only a string, number or literal that is cut off at the end
+  // of a chunk is copied, until the next chunk completes it. finish()
+  // must be called after the last chunk. It throws if the input is
+  // incomplete, and returns the number of values parsed otherwise.
+  // If feed() or finish() throw, the incremental parse is aborted and the
+  // next call to feed() starts a new one. A UTF-8 byte order mark is only
+  // skipped if the first chunk contains it completely.
+  void feed(uint8_t const* chunk, std::size_t size);
+
+  void feed(char const* chunk, std::size_t size) {
+    feed(reinterpret_cast<uint8_t const*>(chunk), size);
+  }
+
+  void feed(std::string const& chunk) {
+    feed(reinterpret_cast<uint8_t const*>(chunk.data()), chunk.size());
+  }
+
+  ValueLength finish();
 
   std::shared_ptr<Builder> steal() {
     // Parser object is broken after a steal()
@@ -232,6 +332,49 @@ class Parser {
 
   ValueLength parseInternal(bool multi);
 
+  // prepares the Builder for a top-level value. returns true if the
+  // value was reported to an open array in the Builder
+  bool prepareTopLevelValue();
+
+  // replaces the attribute name at keyPos in the Builder by its
+  // translation, if there is one
+  void translateAttributeName(ValueLength keyPos);
+
+  void startStream();
+
+  void resetStream();
+
+  // parses the bytes in _start[_pos] to _start[_size] in incremental mode
+  void parseStream();
+
+  // parses a string, number or literal at _pos in incremental mode.
+  // returns false if the token is cut off by the end of the chunk, in
+  // which case its start is moved to _carry
+  bool parseStreamToken();
+
+  // completes the token in _carry with the bytes at the start of the
+  // current chunk and parses it. returns false if the chunk ends before
+  // the token does
+  bool completeCarry();
+
+  // parses a token that is known to be complete
+  void parseCompleteToken();
+
+  // updates the incremental state after a value or attribute name
+  void afterStreamToken();
+
+  // updates the incremental state after a value
+  void afterStreamValue();
+
+  // closes the innermost compound value in incremental mode
+  void closeStreamCompound();
+
+  // checks whether the token starting with first ends within the len
+  // bytes at p. have is the number of token bytes preceding p. sets used
+  // to the number of bytes at p belonging to the token
+  bool findTokenEnd(uint8_t first, uint8_t const* p, std::size_t len,
+                    std::size_t have, std::size_t& used);
+
   inline bool isWhiteSpace(uint8_t i) const noexcept {
     return (i == ' ' || i == '\t' || i == '\n' || i == '\r');
   }
@@ -265,7 +408,47 @@ class Parser {
     _builderPtr->addNull();
   }
 
+  // reads 8 bytes of input as a little-endian number
+  static inline uint64_t readEightBytes(uint8_t const* p) noexcept {
+    uint64_t value;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = 0;
+    for (int i = 7; i >= 0; --i) {
+      value = (value << 8) | p[i];
+    }
+#else
+    memcpy(&value, p, sizeof(value));
+#endif
+    return value;
+  }
+
+  // checks if all 8 bytes read by readEightBytes() are ASCII digits. a
+  // byte is a digit if both it and the byte plus 6 are in 0x30 - 0x39
+  static inline bool isEightDigits(uint64_t value) noexcept {
+    return (((value & 0xf0f0f0f0f0f0f0f0ULL) |
+             (((value + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+  }
+
+  // converts 8 ASCII digits read by readEightBytes() into their numeric
+  // value, combining pairs of digits, then pairs of pairs and so on
+  static inline uint64_t parseEightDigits(uint64_t value) noexcept {
+    value = ((value & 0x0f0f0f0f0f0f0f0fULL) * 2561) >> 8;
+    value = ((value & 0x00ff00ff00ff00ffULL) * 6553601) >> 16;
+    return ((value & 0x0000ffff0000ffffULL) * 42949672960001ULL) >> 32;
+  }
+
   void scanDigits(ParsedNumber& value) {
+    // consume 8 digits at a time as long as the result cannot overflow.
+    // 184467440736 * 10^8 + 99999999 is still below 2^64
+    while (_size - _pos >= 8 && value.mantissa <= 184467440736ULL) {
+      uint64_t const chunk = readEightBytes(_start + _pos);
+      if (!isEightDigits(chunk)) {
+        break;
+      }
+      value.mantissa = value.mantissa * 100000000ULL + parseEightDigits(chunk);
+      _pos += 8;
+    }
     while (true) {
       int i = consume();
       if (i < 0) {
@@ -279,20 +462,48 @@ class Parser {
     }
   }
 
-  double scanDigitsFractional() {
-    double pot = 0.1;
-    double x = 0.0;
+  void scanDigitsFractional(ParsedNumber& value) {
+    // while the mantissa is below 10^10, all of the next 8 digits would
+    // be added to it one at a time
+    while (_size - _pos >= 8 && value.mantissa < 10000000000ULL) {
+      uint64_t const chunk = readEightBytes(_start + _pos);
+      if (!isEightDigits(chunk)) {
+        break;
+      }
+      value.mantissa = value.mantissa * 100000000ULL + parseEightDigits(chunk);
+      value.exponent -= 8;
+      _pos += 8;
+    }
+    while (true) {
+      int i = consume();
+      if (i < 0) {
+        return;
+      }
+      if (i < '0' || i > '9') {
+        unconsume();
+        return;
+      }
+      value.addFractionalDigit(i);
+    }
+  }
+
+  int64_t scanExponent() {
+    // exponents beyond this limit make every non-zero value overflow or
+    // underflow anyway, so there is no need to keep on counting
+    int64_t const limit = 1000000;
+    int64_t value = 0;
     while (true) {
       int i = consume();
       if (i < 0) {
-        return x;
+        return value;
       }
       if (i < '0' || i > '9') {
         unconsume();
-        return x;
+        return value;
+      }
+      if (value < limit) {
+        value = value * 10 + (i - '0');
       }
-      x = x + pot * (i - '0');
-      pot /= 10.0;
     }
   }
 
@@ -310,8 +521,47 @@ class Parser {
 
   void parseNumber();
 
+  // parses a top-level value with options->projection set
+  void parseProjected();
+
+  // parses the members of an Object after the opening '{', keeping only
+  // those selected by the projection node. returns the number of members
+  // added to the Builder
+  ValueLength parseObjectProjected(std::size_t node);
+
+  // the following functions check the syntax of a value without building
+  // it. the value of numbers is not checked
+
+  void skipValue();
+
+  void skipObject();
+
+  void skipArray();
+
+  // skips a string after its opening quote. returns true if the string
+  // contains escape sequences
+  bool skipString();
+
+  void skipNumber();
+
+  void skipDigits() {
+    while (_size - _pos >= 8 && isEightDigits(readEightBytes(_start + _pos))) {
+      _pos += 8;
+    }
+    while (_pos < _size && _start[_pos] >= '0' && _start[_pos] <= '9') {
+      ++_pos;
+    }
+  }
+
+  void addDouble(ParsedNumber const& numberValue, bool negative,
+                 std::size_t startPos);
+
   void parseString();
 
+  // emits a string value as an External into the input during
+  // parseInSitu(). returns false if the string must be copied
+  bool parseStringInSitu();
+
   void parseArray();
 
   void parseObject();
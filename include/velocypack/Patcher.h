@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_PATCHER_H
+#define VELOCYPACK_PATCHER_H 1
+
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/Options.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+class Patcher {
+  // Replaces values inside closed VelocyPack Objects without rebuilding
+  // them. The value to replace is given by a path of attribute names,
+  // starting at the Object at the beginning of the data. If the new
+  // value has the same byte size as the old one, it is simply
+  // overwritten. Otherwise it is spliced in, and the byte sizes and
+  // index tables of the Objects on the path are adjusted. Only an Object
+  // whose byte size no longer fits into its header is built again, from
+  // the unchanged bytes of its members.
+
+ public:
+  Patcher() = delete;
+  Patcher(Patcher const&) = delete;
+  Patcher& operator=(Patcher const&) = delete;
+
+  // replaces the value at path in the Object at the start of buffer.
+  // the data following the Object in the buffer is kept. returns false
+  // if the path does not exist
+  static bool replace(Buffer<uint8_t>& buffer,
+                      std::vector<std::string> const& path, Slice value,
+                      Options const* options = &Options::Defaults);
+
+  // same, for a path of StringRefs
+  template <typename T>
+  static bool replace(Buffer<uint8_t>& buffer, std::vector<T> const& path,
+                      Slice value, Options const* options = &Options::Defaults);
+
+  // replaces the value at path in the Object at start, but only if the
+  // new value has the same byte size as the old one. returns false if
+  // the path does not exist or the byte sizes differ
+  static bool replaceInPlace(uint8_t* start,
+                             std::vector<std::string> const& path,
+                             Slice value);
+
+  // same, for a path of StringRefs
+  template <typename T>
+  static bool replaceInPlace(uint8_t* start, std::vector<T> const& path,
+                             Slice value);
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_PROJECTION_H
+#define VELOCYPACK_PROJECTION_H 1
+
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+
+namespace arangodb {
+namespace velocypack {
+
+class Projection {
+  // A set of attribute paths, such as "user.id" or "tags". If a
+  // Projection is set in the Options, the Parser builds an Object that
+  // contains only the values at these paths, and skips over all other
+  // values without building them. Values that are not Objects cannot be
+  // descended into, so paths leading through them do not match.
+
+ public:
+  // index of the root node
+  static constexpr std::size_t Root = 0;
+  // returned by find() if there is no matching node
+  static constexpr std::size_t NotFound = 0;
+
+  Projection();
+  Projection(std::initializer_list<std::string> paths);
+  explicit Projection(std::vector<std::string> const& paths);
+
+  // adds a path of attribute names, separated by '.'
+  void add(std::string const& path);
+
+  // adds a path given as a list of attribute names
+  void add(std::vector<std::string> const& path);
+
+  bool empty() const noexcept { return _nodes.size() == 1; }
+
+  // returns the child node of parent with the given attribute name, or
+  // NotFound
+  std::size_t find(std::size_t parent, char const* name,
+                   std::size_t length) const noexcept {
+    for (std::size_t i : _nodes[parent].children) {
+      Node const& node = _nodes[i];
+      if (node.name.size() == length &&
+          memcmp(node.name.data(), name, length) == 0) {
+        return i;
+      }
+    }
+    return NotFound;
+  }
+
+  // whether the complete value at the node is selected
+  bool isComplete(std::size_t node) const noexcept {
+    return _nodes[node].complete;
+  }
+
+ private:
+  struct Node {
+    explicit Node(std::string name)
+        : name(std::move(name)), complete(false) {}
+
+    std::string name;
+    // indexes of the child nodes in _nodes
+    std::vector<std::size_t> children;
+    bool complete;
+  };
+
+  // all nodes. children are always stored after their parent
+  std::vector<Node> _nodes;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
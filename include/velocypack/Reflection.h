@@ -0,0 +1,421 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_REFLECTION_H
+#define VELOCYPACK_REFLECTION_H 1
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Describes the fields of a struct. Specialized by VELOCYPACK_REFLECT,
+// which provides
+//   static constexpr std::size_t size();
+//   static StringRef const* names();
+//   static void encode(Builder&, T const&);  // adds all fields to an open Object
+//   static void decode(T&, std::size_t field, Slice value);
+template <typename T>
+struct ReflectFields;
+
+// Converts a single value. Specialized for bools, numbers, strings,
+// vectors and reflected structs, and can be specialized for other types
+// by providing
+//   static void encode(Builder&, T const&);
+//   static void encode(Builder&, StringRef key, T const&);
+//   static void decode(Slice, T&);
+template <typename T, typename Enable = void>
+struct ReflectValue;
+
+// Maps attribute names to field numbers with a perfect hash, which is
+// built once per reflected type. A lookup hashes the name once and
+// compares it with a single candidate.
+class ReflectIndex {
+ public:
+  static constexpr std::size_t notFound = ~std::size_t(0);
+
+  ReflectIndex(StringRef const* names, std::size_t n);
+
+  std::size_t find(StringRef name) const noexcept {
+    uint8_t slot = _slots[hash(name.data(), name.size(), _seed) & _mask];
+    if (slot == 0) {
+      return notFound;
+    }
+    --slot;
+    StringRef const& candidate = _names[slot];
+    if (candidate.size() != name.size() ||
+        memcmp(candidate.data(), name.data(), name.size()) != 0) {
+      return notFound;
+    }
+    return slot;
+  }
+
+ private:
+  static uint64_t hash(char const* p, std::size_t size, uint64_t seed) noexcept {
+    return VELOCYPACK_HASH(p, size, seed);
+  }
+
+  bool tryBuild(uint64_t seed, uint64_t mask);
+
+ private:
+  StringRef const* _names;
+  std::size_t _n;
+  uint64_t _seed;
+  uint64_t _mask;
+  std::vector<uint8_t> _slots;  // field number + 1, or 0 for no field
+};
+
+class Reflect {
+  // Serializes structs described with VELOCYPACK_REFLECT to Objects and
+  // back, without virtual calls. Decoding walks the Object once and
+  // looks up every attribute name in the ReflectIndex of the struct.
+  // Attributes without a field are ignored, and fields without an
+  // attribute keep their value.
+
+ public:
+  Reflect() = delete;
+  Reflect(Reflect const&) = delete;
+  Reflect& operator=(Reflect const&) = delete;
+
+  template <typename T>
+  static void toVelocyPack(T const& value, Builder& builder) {
+    ReflectValue<T>::encode(builder, value);
+  }
+
+  template <typename T>
+  static void fromVelocyPack(Slice slice, T& value) {
+    ReflectValue<T>::decode(slice, value);
+  }
+
+  template <typename T>
+  static T fromVelocyPack(Slice slice) {
+    T value{};
+    ReflectValue<T>::decode(slice, value);
+    return value;
+  }
+
+  // the field index of T, built on first use
+  template <typename T>
+  static ReflectIndex const& index() {
+    static ReflectIndex const index(ReflectFields<T>::names(),
+                                    ReflectFields<T>::size());
+    return index;
+  }
+
+  template <typename T>
+  static void decodeFields(Slice slice, T& value) {
+    if (VELOCYPACK_UNLIKELY(!slice.isObject())) {
+      throw Exception(Exception::InvalidValueType, "Expecting type Object");
+    }
+    ReflectIndex const& fields = index<T>();
+    ObjectIterator it(slice, true);
+    while (it.valid()) {
+      Slice key = it.key(true);
+      if (key.isString()) {
+        std::size_t field = fields.find(key.stringRef());
+        if (field != ReflectIndex::notFound) {
+          ReflectFields<T>::decode(value, field, it.value());
+        }
+      }
+      it.next();
+    }
+  }
+};
+
+template <typename T>
+struct ReflectValue<T, typename std::enable_if<std::is_same<T, bool>::value>::type> {
+  static void encode(Builder& b, T value) { b.add(value); }
+  static void encode(Builder& b, StringRef key, T value) { b.add(key, value); }
+  static void decode(Slice s, T& value) { value = s.getBool(); }
+};
+
+template <typename T>
+struct ReflectValue<T, typename std::enable_if<std::is_arithmetic<T>::value &&
+                                               !std::is_same<T, bool>::value>::type> {
+  static void encode(Builder& b, T value) { b.add(value); }
+  static void encode(Builder& b, StringRef key, T value) { b.add(key, value); }
+  static void decode(Slice s, T& value) { value = s.getNumber<T>(); }
+};
+
+template <>
+struct ReflectValue<std::string> {
+  static void encode(Builder& b, std::string const& value) { b.add(value); }
+  static void encode(Builder& b, StringRef key, std::string const& value) {
+    b.add(key, value);
+  }
+  static void decode(Slice s, std::string& value) {
+    StringRef ref = s.stringRef();
+    value.assign(ref.data(), ref.size());
+  }
+};
+
+template <typename T>
+struct ReflectValue<std::vector<T>> {
+  static void encode(Builder& b, std::vector<T> const& value) {
+    b.openArray();
+    encodeMembers(b, value);
+  }
+  static void encode(Builder& b, StringRef key, std::vector<T> const& value) {
+    b.add(key, Value(ValueType::Array));
+    encodeMembers(b, value);
+  }
+  static void decode(Slice s, std::vector<T>& value) {
+    ArrayIterator it(s);
+    value.clear();
+    value.reserve(checkOverflow(it.size()));
+    while (it.valid()) {
+      value.emplace_back();
+      ReflectValue<T>::decode(it.value(), value.back());
+      it.next();
+    }
+  }
+
+ private:
+  static void encodeMembers(Builder& b, std::vector<T> const& value) {
+    for (auto const& member : value) {
+      ReflectValue<T>::encode(b, member);
+    }
+    b.close();
+  }
+};
+
+template <typename T>
+struct ReflectValue<T, typename std::enable_if<(ReflectFields<T>::size() > 0)>::type> {
+  static void encode(Builder& b, T const& value) {
+    b.openObject();
+    ReflectFields<T>::encode(b, value);
+    b.close();
+  }
+  static void encode(Builder& b, StringRef key, T const& value) {
+    b.add(key, Value(ValueType::Object));
+    ReflectFields<T>::encode(b, value);
+    b.close();
+  }
+  static void decode(Slice s, T& value) { Reflect::decodeFields(s, value); }
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#define VELOCYPACK_REFLECT_EXPAND(x) x
+#define VELOCYPACK_REFLECT_CAT(a, b) VELOCYPACK_REFLECT_CAT_(a, b)
+#define VELOCYPACK_REFLECT_CAT_(a, b) a##b
+#define VELOCYPACK_REFLECT_NARGS(...) \
+  VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_NARGS_(__VA_ARGS__, \
+    64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, \
+    48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, \
+    32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, \
+    16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define VELOCYPACK_REFLECT_NARGS_( \
+    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, \
+    _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, \
+    _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64, \
+    N, ...) N
+#define VELOCYPACK_REFLECT_FE_1(m, d, i, a) m(d, i, a)
+#define VELOCYPACK_REFLECT_FE_2(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_1(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_3(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_2(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_4(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_3(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_5(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_4(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_6(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_5(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_7(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_6(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_8(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_7(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_9(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_8(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_10(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_9(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_11(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_10(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_12(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_11(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_13(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_12(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_14(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_13(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_15(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_14(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_16(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_15(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_17(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_16(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_18(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_17(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_19(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_18(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_20(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_19(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_21(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_20(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_22(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_21(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_23(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_22(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_24(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_23(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_25(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_24(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_26(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_25(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_27(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_26(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_28(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_27(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_29(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_28(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_30(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_29(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_31(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_30(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_32(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_31(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_33(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_32(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_34(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_33(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_35(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_34(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_36(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_35(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_37(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_36(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_38(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_37(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_39(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_38(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_40(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_39(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_41(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_40(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_42(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_41(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_43(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_42(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_44(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_43(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_45(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_44(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_46(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_45(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_47(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_46(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_48(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_47(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_49(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_48(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_50(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_49(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_51(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_50(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_52(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_51(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_53(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_52(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_54(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_53(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_55(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_54(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_56(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_55(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_57(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_56(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_58(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_57(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_59(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_58(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_60(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_59(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_61(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_60(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_62(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_61(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_63(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_62(m, d, i + 1, __VA_ARGS__))
+#define VELOCYPACK_REFLECT_FE_64(m, d, i, a, ...) \
+  m(d, i, a) VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_FE_63(m, d, i + 1, __VA_ARGS__))
+
+#define VELOCYPACK_REFLECT_FOR_EACH(m, d, ...)                     \
+  VELOCYPACK_REFLECT_EXPAND(VELOCYPACK_REFLECT_CAT(                \
+      VELOCYPACK_REFLECT_FE_, VELOCYPACK_REFLECT_NARGS(__VA_ARGS__))( \
+      m, d, 0, __VA_ARGS__))
+
+#define VELOCYPACK_REFLECT_NAME(d, i, field) \
+  ::arangodb::velocypack::StringRef(#field, sizeof(#field) - 1),
+#define VELOCYPACK_REFLECT_ENCODE(d, i, field)                          \
+  ::arangodb::velocypack::ReflectValue<decltype(d.field)>::encode(      \
+      b, ::arangodb::velocypack::StringRef(#field, sizeof(#field) - 1), \
+      d.field);
+#define VELOCYPACK_REFLECT_DECODE(d, i, field)                             \
+  case i:                                                                  \
+    ::arangodb::velocypack::ReflectValue<decltype(d.field)>::decode(slice, \
+                                                                    d.field); \
+    break;
+
+// Describes the fields of a struct for Reflect, e.g.
+//   VELOCYPACK_REFLECT(ns::Point, x, y, label)
+// Must be used at global scope, with up to 64 fields
+#define VELOCYPACK_REFLECT(Type, ...)                                        \
+  namespace arangodb {                                                       \
+  namespace velocypack {                                                     \
+  template <>                                                                \
+  struct ReflectFields<Type> {                                               \
+    static constexpr std::size_t size() {                                    \
+      return VELOCYPACK_REFLECT_NARGS(__VA_ARGS__);                          \
+    }                                                                        \
+    static StringRef const* names() {                                        \
+      static StringRef const names[] = {                                     \
+          VELOCYPACK_REFLECT_FOR_EACH(VELOCYPACK_REFLECT_NAME, _, __VA_ARGS__)}; \
+      return names;                                                          \
+    }                                                                        \
+    static void encode(Builder& b, Type const& value) {                      \
+      VELOCYPACK_REFLECT_FOR_EACH(VELOCYPACK_REFLECT_ENCODE, value, __VA_ARGS__) \
+    }                                                                        \
+    static void decode(Type& value, std::size_t field, Slice slice) {        \
+      switch (field) {                                                       \
+        VELOCYPACK_REFLECT_FOR_EACH(VELOCYPACK_REFLECT_DECODE, value, __VA_ARGS__) \
+        default:                                                             \
+          break;                                                             \
+      }                                                                      \
+    }                                                                        \
+  };                                                                         \
+  }                                                                          \
+  }
+
+#endif
@@ -31,6 +31,7 @@
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Buffer.h"
+#include "velocypack/Exception.h"
 
 namespace arangodb {
 namespace velocypack {
@@ -48,8 +49,16 @@ struct Sink {
   virtual void reserve(ValueLength len) = 0;
 };
 
+// a Sink that allows overwriting data that it has received before
+struct PatchableSink : public Sink {
+  // the position at which the next data will be appended
+  virtual ValueLength position() = 0;
+  // overwrites len bytes, starting at position
+  virtual void patch(ValueLength position, char const* p, ValueLength len) = 0;
+};
+
 template <typename T>
-struct ByteBufferSinkImpl final : public Sink {
+struct ByteBufferSinkImpl final : public PatchableSink {
   explicit ByteBufferSinkImpl(Buffer<T>* buffer) : buffer(buffer) {}
 
   void push_back(char c) override final { buffer->push_back(c); }
@@ -66,13 +75,20 @@ struct ByteBufferSinkImpl final : public Sink {
 
   void reserve(ValueLength len) override final { buffer->reserve(len); }
 
+  ValueLength position() override final { return buffer->size(); }
+
+  void patch(ValueLength position, char const* p, ValueLength len) override final {
+    VELOCYPACK_ASSERT(position + len <= buffer->size());
+    memcpy(buffer->data() + position, p, checkOverflow(len));
+  }
+
   Buffer<T>* buffer;
 };
 
 typedef ByteBufferSinkImpl<char> CharBufferSink;
 
 template <typename T>
-struct StringSinkImpl final : public Sink {
+struct StringSinkImpl final : public PatchableSink {
   explicit StringSinkImpl(T* buffer) : buffer(buffer) {}
 
   void push_back(char c) override final { buffer->push_back(c); }
@@ -93,13 +109,20 @@ struct StringSinkImpl final : public Sink {
     buffer->reserve(checkOverflow(length));
   }
 
+  ValueLength position() override final { return buffer->size(); }
+
+  void patch(ValueLength position, char const* p, ValueLength len) override final {
+    VELOCYPACK_ASSERT(position + len <= buffer->size());
+    buffer->replace(checkOverflow(position), checkOverflow(len), p, checkOverflow(len));
+  }
+
   T* buffer;
 };
 
 typedef StringSinkImpl<std::string> StringSink;
 
 template <typename T>
-struct StreamSinkImpl final : public Sink {
+struct StreamSinkImpl final : public PatchableSink {
   explicit StreamSinkImpl(T* stream) : stream(stream) {}
 
   void push_back(char c) override final { *stream << c; }
@@ -116,7 +139,31 @@ struct StreamSinkImpl final : public Sink {
 
   void reserve(ValueLength) override final {}
 
+  ValueLength position() override final {
+    return static_cast<ValueLength>(tell());
+  }
+
+  void patch(ValueLength position, char const* p, ValueLength len) override final {
+    auto const current = tell();
+    stream->seekp(static_cast<typename T::pos_type>(position));
+    stream->write(p, static_cast<std::streamsize>(len));
+    stream->seekp(current);
+    if (VELOCYPACK_UNLIKELY(stream->fail())) {
+      throw Exception(Exception::InternalError, "Cannot patch output stream");
+    }
+  }
+
   T* stream;
+
+ private:
+  typename T::pos_type tell() {
+    auto const current = stream->tellp();
+    if (VELOCYPACK_UNLIKELY(current == typename T::pos_type(-1))) {
+      throw Exception(Exception::InternalError,
+                      "Cannot determine position in output stream");
+    }
+    return current;
+  }
 };
 
 typedef StreamSinkImpl<std::ostringstream> StringStreamSink;
@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <functional>
 #include <type_traits>
+#include <limits>
 
 #if __cplusplus >= 201703L
 #include <string_view>
@@ -340,7 +341,8 @@ class Slice {
   // check if slice is a SmallInt object
   constexpr bool isSmallInt() const noexcept { return isType(ValueType::SmallInt); }
 
-  // check if slice is a String object
+  // check if slice is a String object. this is false for an External
+  // pointing to a String, as written by Parser::parseInSitu()
   constexpr bool isString() const noexcept { return isType(ValueType::String); }
 
   // check if slice is a Binary object
@@ -581,6 +583,13 @@ class Slice {
   Slice get(char const* attribute, std::size_t length) const {
     return get(StringRef(attribute, length));
   }
+
+  // look for multiple attributes inside an Object in a single pass.
+  // the attributes must be sorted as by StringRef::compare. stores the
+  // value for attributes[i] in values[i], or a Slice(ValueType::None) if
+  // it is not found. returns the number of attributes found
+  ValueLength get(StringRef const* attributes, std::size_t n,
+                  Slice* values) const;
   
   Slice operator[](StringRef const& attribute) const {
     return get(attribute);
@@ -731,7 +740,8 @@ class Slice {
     return toInt64(v);
   }
 
-  // return the value for a String object
+  // return the value for a String object. the string accessors also
+  // accept an External pointing to a String
   char const* getString(ValueLength& length) const {
     uint8_t const h = head();
     if (h >= 0x40 && h <= 0xbe) {
@@ -747,6 +757,10 @@ class Slice {
       return reinterpret_cast<char const*>(start() + 1 + 8);
     }
 
+    if (h == 0x1d) {
+      return resolveExternals().getString(length);
+    }
+
     throw Exception(Exception::InvalidValueType, "Expecting type String");
   }
   
@@ -777,6 +791,10 @@ class Slice {
       return readIntegerFixed<ValueLength, 8>(start() + 1);
     }
 
+    if (h == 0x1d) {
+      return resolveExternals().getStringLength();
+    }
+
     throw Exception(Exception::InvalidValueType, "Expecting type String");
   }
 
@@ -796,6 +814,10 @@ class Slice {
                          checkOverflow(length));
     }
 
+    if (h == 0x1d) {
+      return resolveExternals().copyString();
+    }
+
     throw Exception(Exception::InvalidValueType, "Expecting type String");
   }
   
@@ -815,6 +837,10 @@ class Slice {
                        checkOverflow(length));
     }
 
+    if (h == 0x1d) {
+      return resolveExternals().stringRef();
+    }
+
     throw Exception(Exception::InvalidValueType, "Expecting type String");
   }
 #ifdef VELOCYPACK_HAS_STRING_VIEW
@@ -1134,6 +1160,23 @@ class Slice {
   template<ValueLength offsetSize>
   Slice searchObjectKeyBinary(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
 
+  // perform a branchless binary search with prefetching for the specified
+  // attribute inside a large Object
+  template<ValueLength offsetSize>
+  Slice searchObjectKeyPrefetch(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
+
+  // look for multiple sorted attributes by iterating over all members
+  // of an Object
+  ValueLength searchObjectKeysLinear(StringRef const* attributes, std::size_t n,
+                                     Slice* values) const;
+
+  // look for multiple sorted attributes in a single forward pass over the
+  // sorted index table of an Object
+  template<ValueLength offsetSize>
+  ValueLength searchObjectKeysBinary(StringRef const* attributes, std::size_t n,
+                                     Slice* values, ValueLength ieBase,
+                                     ValueLength entries) const;
+
   // extracts a pointer from the slice and converts it into a
   // built-in pointer type
   char const* extractPointer() const {
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_STREAMBUILDER_H
+#define VELOCYPACK_STREAMBUILDER_H 1
+
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Options.h"
+#include "velocypack/Sink.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+class StreamBuilder {
+  // Writes an Array or Object to a PatchableSink one member at a time.
+  // The members are either added as Slices or built in the Builder
+  // returned by builder() and then flushed.
+  //
+  // Arrays are written with type 0x09 and Objects with type 0x0e, i.e.
+  // with an 8-byte byte length, 8-byte offsets and the number of members
+  // behind the index table. The byte length is written as a placeholder
+  // with the first member and patched by close(), which appends the index
+  // table. Compact Arrays and Objects (0x13, 0x14) cannot be streamed,
+  // because the size of their byte length depends on its value.
+  //
+  // Apart from the member being built, memory is bounded by the index
+  // table, i.e. 8 bytes per member. For an Object, the attribute names
+  // are kept as well, because its index table must be sorted by them.
+  // Attribute names must be Strings. If Options::checkAttributeUniqueness
+  // is set, close() throws after writing an Object with duplicate names.
+
+ public:
+  explicit StreamBuilder(PatchableSink* sink,
+                         Options const* options = &Options::Defaults);
+
+  StreamBuilder(StreamBuilder const&) = delete;
+  StreamBuilder& operator=(StreamBuilder const&) = delete;
+
+  void openArray();
+  void openObject();
+
+  // appends a member to the open Array
+  void add(Slice value);
+
+  // appends a member to the open Object
+  void add(StringRef key, Slice value);
+
+  // a Builder for the next members. all values added to it at the top
+  // level become members when flush() is called. for an Object they
+  // must alternate between string keys and values
+  Builder& builder() noexcept { return _builder; }
+
+  // writes the members in builder() to the sink and clears it
+  void flush();
+
+  // writes the remaining members, the index table and the number of
+  // members, and patches the byte length of the container in the sink
+  void close();
+
+  bool isOpen() const noexcept { return _head != 0; }
+
+  // number of members written so far
+  ValueLength length() const noexcept {
+    return _offsets.size() + _keys.size();
+  }
+
+ private:
+  // an Object member, with the position of its name in _names
+  struct Key {
+    ValueLength offset;
+    std::size_t nameStart;
+    std::size_t nameLength;
+  };
+
+  void checkOpen(uint8_t head) const;
+  void open(uint8_t head);
+  void writeHeader();
+  void write(uint8_t const* p, ValueLength size);
+  void writeIndexTable(bool isObject);
+
+ private:
+  PatchableSink* _sink;
+  Builder _builder;
+  uint8_t _head;       // 0x09 or 0x0e while open, 0 otherwise
+  ValueLength _start;  // position of the container in the sink
+  ValueLength _length;  // bytes of the container written so far
+  std::vector<ValueLength> _offsets;  // Array members
+  std::vector<Key> _keys;             // Object members
+  std::string _names;                 // attribute names of the Object
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -56,7 +56,8 @@ class StringRef {
   explicit StringRef(char const* data) noexcept : StringRef(data, strlen(data)) {}
 #endif
    
-  /// @brief create a StringRef from a VPack slice (must be of type String)
+  /// @brief create a StringRef from a VPack slice (must be of type String, or an
+  /// External pointing to one, as from Parser::parseInSitu())
   explicit StringRef(Slice slice);
   
   /// @brief create a StringRef from a HashedStringRef
@@ -98,7 +99,8 @@ class StringRef {
     return *this;
   }
   
-  /// @brief create a StringRef from a VPack slice of type String
+  /// @brief create a StringRef from a VPack slice of type String, or an
+  /// External pointing to one
   StringRef& operator=(Slice slice);
   
   /// @brief create a StringRef from another HashedStringRef
@@ -74,10 +74,20 @@ template<typename T> using VPackBuffer = arangodb::velocypack::Buffer<T>;
 #endif
 #endif
 
+#ifdef VELOCYPACK_MEMORYRESOURCE_H
+#ifndef VELOCYPACK_ALIAS_MEMORYRESOURCE
+#define VELOCYPACK_ALIAS_MEMORYRESOURCE
+using VPackMemoryResource = arangodb::velocypack::MemoryResource;
+using VPackArenaMemoryResource = arangodb::velocypack::ArenaMemoryResource;
+template<typename T> using VPackResourceAllocator = arangodb::velocypack::ResourceAllocator<T>;
+#endif
+#endif
+
 #ifdef VELOCYPACK_SINK_H
 #ifndef VELOCYPACK_ALIAS_SINK
 #define VELOCYPACK_ALIAS_SINK
 using VPackSink = arangodb::velocypack::Sink;
+using VPackPatchableSink = arangodb::velocypack::PatchableSink;
 using VPackCharBufferSink = arangodb::velocypack::CharBufferSink;
 using VPackStringSink = arangodb::velocypack::StringSink;
 using VPackStringStreamSink = arangodb::velocypack::StringStreamSink;
@@ -91,6 +101,20 @@ using VPackCollection = arangodb::velocypack::Collection;
 #endif
 #endif
 
+#ifdef VELOCYPACK_COMPACTINDEX_H
+#ifndef VELOCYPACK_ALIAS_COMPACTINDEX
+#define VELOCYPACK_ALIAS_COMPACTINDEX
+using VPackCompactIndex = arangodb::velocypack::CompactIndex;
+#endif
+#endif
+
+#ifdef VELOCYPACK_ATTRIBUTEPATH_H
+#ifndef VELOCYPACK_ALIAS_ATTRIBUTEPATH
+#define VELOCYPACK_ALIAS_ATTRIBUTEPATH
+using VPackAttributePath = arangodb::velocypack::AttributePath;
+#endif
+#endif
+
 #ifdef VELOCYPACK_ATTRIBUTETRANSLATOR_H
 #ifndef VELOCYPACK_ALIAS_ATTRIBUTETRANSLATOR
 #define VELOCYPACK_ALIAS_ATTRIBUTETRANSLATOR
@@ -134,6 +158,13 @@ using VPackCustomTypeHandler = arangodb::velocypack::CustomTypeHandler;
 #endif
 #endif
 
+#ifdef VELOCYPACK_BATCHPARSER_H
+#ifndef VELOCYPACK_ALIAS_BATCHPARSER
+#define VELOCYPACK_ALIAS_BATCHPARSER
+using VPackBatchParser = arangodb::velocypack::BatchParser;
+#endif
+#endif
+
 #ifdef VELOCYPACK_PARSER_H
 #ifndef VELOCYPACK_ALIAS_PARSER
 #define VELOCYPACK_ALIAS_PARSER
@@ -141,6 +172,27 @@ using VPackParser = arangodb::velocypack::Parser;
 #endif
 #endif
 
+#ifdef VELOCYPACK_PATCHER_H
+#ifndef VELOCYPACK_ALIAS_PATCHER
+#define VELOCYPACK_ALIAS_PATCHER
+using VPackPatcher = arangodb::velocypack::Patcher;
+#endif
+#endif
+
+#ifdef VELOCYPACK_PROJECTION_H
+#ifndef VELOCYPACK_ALIAS_PROJECTION
+#define VELOCYPACK_ALIAS_PROJECTION
+using VPackProjection = arangodb::velocypack::Projection;
+#endif
+#endif
+
+#ifdef VELOCYPACK_REFLECTION_H
+#ifndef VELOCYPACK_ALIAS_REFLECTION
+#define VELOCYPACK_ALIAS_REFLECTION
+using VPackReflect = arangodb::velocypack::Reflect;
+#endif
+#endif
+
 #ifdef VELOCYPACK_SERIALIZABLE_H
 #ifndef VELOCYPACK_ALIAS_SERIALIZABLE
 #define VELOCYPACK_ALIAS_SERIALIZABLE
@@ -163,6 +215,13 @@ using VPackSliceContainer = arangodb::velocypack::SliceContainer;
 #endif
 #endif
 
+#ifdef VELOCYPACK_STREAMBUILDER_H
+#ifndef VELOCYPACK_ALIAS_STREAMBUILDER
+#define VELOCYPACK_ALIAS_STREAMBUILDER
+using VPackStreamBuilder = arangodb::velocypack::StreamBuilder;
+#endif
+#endif
+
 #ifdef VELOCYPACK_STRINGREF_H
 #ifndef VELOCYPACK_ALIAS_STRINGREF
 #define VELOCYPACK_ALIAS_STRINGREF
@@ -33,9 +33,11 @@
 #if defined(__GNUC__) || defined(__GNUG__)
 #define VELOCYPACK_LIKELY(v) __builtin_expect(!!(v), 1)
 #define VELOCYPACK_UNLIKELY(v) __builtin_expect(!!(v), 0)
+#define VELOCYPACK_PREFETCH(p) __builtin_prefetch(p)
 #else
 #define VELOCYPACK_LIKELY(v) v
 #define VELOCYPACK_UNLIKELY(v) v
+#define VELOCYPACK_PREFETCH(p)
 #endif
 
 // debug mode
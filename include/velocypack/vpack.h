@@ -26,21 +26,29 @@
 #define VELOCYPACK_VPACK_H 1
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AttributePath.h"
 #include "velocypack/AttributeTranslator.h"
+#include "velocypack/BatchParser.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
+#include "velocypack/CompactIndex.h"
 #include "velocypack/Compare.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/MemoryResource.h"
 #include "velocypack/Options.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Patcher.h"
+#include "velocypack/Projection.h"
+#include "velocypack/Reflection.h"
 #include "velocypack/Serializable.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
+#include "velocypack/StreamBuilder.h"
 #include "velocypack/StringRef.h"
 #include "velocypack/Utf8Helper.h"
 #include "velocypack/Validator.h"
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AttributePath.h"
+#include "velocypack/Exception.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// no position remembered yet
+constexpr ValueLength noIndex = ~ValueLength(0);
+
+// whether an indexed Object has its index table sorted by key
+inline bool isSorted(uint8_t head) noexcept {
+  return head >= 0x0b && head <= 0x0e;
+}
+
+}  // namespace
+
+AttributePath::AttributePath(std::initializer_list<std::string> components)
+    : AttributePath(std::vector<std::string>(components)) {}
+
+AttributePath::AttributePath(std::vector<std::string> const& components)
+    : _hits(0), _misses(0) {
+  if (components.empty()) {
+    throw Exception(Exception::InvalidAttributePath);
+  }
+  _components.reserve(components.size());
+  for (auto const& name : components) {
+    _components.push_back(Component{name, noIndex});
+  }
+}
+
+AttributePath::AttributePath(std::vector<StringRef> const& components)
+    : _hits(0), _misses(0) {
+  if (components.empty()) {
+    throw Exception(Exception::InvalidAttributePath);
+  }
+  _components.reserve(components.size());
+  for (auto const& name : components) {
+    _components.push_back(Component{name.toString(), noIndex});
+  }
+}
+
+Slice AttributePath::get(Slice slice, bool resolveExternals) {
+  if (resolveExternals) {
+    slice = slice.resolveExternal();
+  }
+  if (VELOCYPACK_UNLIKELY(!slice.isObject())) {
+    throw Exception(Exception::InvalidValueType, "Expecting Object");
+  }
+
+  std::size_t const n = _components.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    slice = lookup(slice, _components[i]);
+
+    // abort as early as possible
+    if (slice.isExternal()) {
+      slice = slice.resolveExternal();
+    }
+
+    if (slice.isNone() || (i + 1 < n && !slice.isObject())) {
+      return Slice();
+    }
+  }
+
+  return slice;
+}
+
+Slice AttributePath::lookup(Slice object, Component& component) {
+  uint8_t const h = object.head();
+  if (h == 0x0a) {
+    // empty Object
+    return Slice();
+  }
+  if (h == 0x14) {
+    // compact Object, there is no index table to remember a position in
+    ++_misses;
+    return object.get(component.name);
+  }
+
+  StringRef const name(component.name);
+  ValueLength const n = object.length();
+
+  if (component.index < n) {
+    Slice key = object.keyAt(component.index, false);
+    if (key.makeKey().isEqualString(name)) {
+      ++_hits;
+      return Slice(key.start() + key.byteSize());
+    }
+  }
+
+  ++_misses;
+  if (isSorted(h)) {
+    ValueLength l = 0;
+    ValueLength r = n;
+    while (l < r) {
+      ValueLength const index = l + ((r - l) / 2);
+      Slice key = object.keyAt(index, false);
+      int res = key.makeKey().compareString(name);
+      if (res == 0) {
+        component.index = index;
+        return Slice(key.start() + key.byteSize());
+      }
+      if (res > 0) {
+        r = index;
+      } else {
+        l = index + 1;
+      }
+    }
+  } else {
+    for (ValueLength index = 0; index < n; ++index) {
+      Slice key = object.keyAt(index, false);
+      if (key.makeKey().isEqualString(name)) {
+        component.index = index;
+        return Slice(key.start() + key.byteSize());
+      }
+    }
+  }
+
+  // not found
+  return Slice();
+}
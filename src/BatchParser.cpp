@@ -0,0 +1,277 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/BatchParser.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Parser.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// inputs smaller than this per thread are not worth a thread of their own
+constexpr std::size_t MinChunkSize = 64 * 1024;
+
+struct Chunk {
+  Chunk(std::size_t start, std::size_t end)
+      : start(start), end(end), count(0), errorPos(0) {}
+
+  std::size_t start;
+  std::size_t end;
+  std::shared_ptr<Builder> builder;
+  ValueLength count;
+  std::exception_ptr error;
+  std::size_t errorPos;
+};
+
+bool isWhiteSpaceOnly(uint8_t const* p, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    if (p[i] != ' ' && p[i] != '\t' && p[i] != '\n' && p[i] != '\r') {
+      return false;
+    }
+  }
+  return true;
+}
+
+void parseChunk(Options const* options, uint8_t const* start, Chunk& chunk) {
+  if (isWhiteSpaceOnly(start + chunk.start, chunk.end - chunk.start)) {
+    // e.g. trailing empty lines
+    return;
+  }
+  try {
+    Parser parser(options);
+    try {
+      chunk.count = parser.parse(start + chunk.start, chunk.end - chunk.start, true);
+    } catch (...) {
+      chunk.errorPos = chunk.start + parser.errorPos();
+      throw;
+    }
+    chunk.builder = parser.steal();
+  } catch (...) {
+    chunk.error = std::current_exception();
+  }
+}
+
+}  // namespace
+
+// long-lived worker threads that run the tasks posted to their queue
+class BatchParser::WorkerPool {
+ public:
+  explicit WorkerPool(std::size_t threads) : _pending(0), _stop(false) {
+    _workers.reserve(threads);
+    try {
+      for (std::size_t i = 0; i < threads; ++i) {
+        _workers.emplace_back([this]() { run(); });
+      }
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  ~WorkerPool() { stop(); }
+
+  std::size_t size() const noexcept { return _workers.size(); }
+
+  // queues a task. tasks must not throw
+  void post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _queue.push_back(std::move(task));
+      ++_pending;
+    }
+    _wake.notify_one();
+  }
+
+  // waits until all posted tasks have run
+  void wait() {
+    std::unique_lock<std::mutex> guard(_lock);
+    _done.wait(guard, [this]() { return _pending == 0; });
+  }
+
+ private:
+  void run() {
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true) {
+      _wake.wait(guard, [this]() { return _stop || !_queue.empty(); });
+      if (_queue.empty()) {
+        // stopped
+        return;
+      }
+      std::function<void()> task = std::move(_queue.front());
+      _queue.pop_front();
+      guard.unlock();
+      task();
+      guard.lock();
+      if (--_pending == 0) {
+        _done.notify_all();
+      }
+    }
+  }
+
+  void stop() noexcept {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) {
+      worker.join();
+    }
+  }
+
+  std::vector<std::thread> _workers;
+  std::mutex _lock;
+  std::condition_variable _wake;  // a task was queued or the pool stops
+  std::condition_variable _done;  // all tasks have run
+  std::deque<std::function<void()>> _queue;
+  std::size_t _pending;           // tasks queued or running
+  bool _stop;
+};
+
+BatchParser::BatchParser(Options const* options, std::size_t threads)
+    : options(options), _threads(threads), _errorPos(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  if (_threads == 0) {
+    _threads = (std::max)(std::thread::hardware_concurrency(), 1U);
+  }
+}
+
+BatchParser::~BatchParser() = default;
+
+std::size_t BatchParser::workers() const noexcept {
+  return _pool == nullptr ? 0 : _pool->size();
+}
+
+ValueLength BatchParser::parse(uint8_t const* start, std::size_t size) {
+  _buffer.reset();
+  _offsets.clear();
+  _errorPos = 0;
+
+  if (isWhiteSpaceOnly(start, size)) {
+    // let the Parser report the error
+    Parser parser(options);
+    try {
+      parser.parse(start, size, true);
+    } catch (...) {
+      _errorPos = parser.errorPos();
+      throw;
+    }
+    return 0;
+  }
+
+  // split the input into chunks of about the same size, each ending
+  // after a line break
+  std::size_t const n = (std::min)(_threads, (std::max)(size / MinChunkSize, std::size_t(1)));
+  std::vector<Chunk> chunks;
+  chunks.reserve(n);
+  std::size_t begin = 0;
+  for (std::size_t i = 1; i <= n && begin < size; ++i) {
+    std::size_t end = size;
+    if (i < n) {
+      end = (std::max)(begin, size / n * i);
+      void const* lineBreak = memchr(start + end, '\n', size - end);
+      if (lineBreak != nullptr) {
+        end = static_cast<uint8_t const*>(lineBreak) - start + 1;
+      } else {
+        end = size;
+      }
+    }
+    chunks.emplace_back(begin, end);
+    begin = end;
+  }
+
+  // the calling thread parses the first chunk itself
+  if (chunks.size() > 1) {
+    if (_pool == nullptr) {
+      _pool.reset(new WorkerPool(_threads - 1));
+    }
+    try {
+      for (std::size_t i = 1; i < chunks.size(); ++i) {
+        Chunk& chunk = chunks[i];
+        _pool->post([this, start, &chunk]() {
+          parseChunk(options, start, chunk);
+        });
+      }
+    } catch (...) {
+      // the queued tasks refer to chunks
+      _pool->wait();
+      throw;
+    }
+  }
+  parseChunk(options, start, chunks[0]);
+  if (chunks.size() > 1) {
+    _pool->wait();
+  }
+
+  // report the first error in input order
+  ValueLength total = 0;
+  for (auto const& chunk : chunks) {
+    if (chunk.error) {
+      _errorPos = chunk.errorPos;
+      std::rethrow_exception(chunk.error);
+    }
+    if (chunk.builder != nullptr) {
+      total += chunk.builder->size();
+    }
+  }
+
+  // concatenate the results and collect the document offsets
+  _buffer.reserve(total);
+  for (auto const& chunk : chunks) {
+    if (chunk.builder == nullptr) {
+      continue;
+    }
+    _offsets.reserve(_offsets.size() + chunk.count);
+    uint8_t const* p = chunk.builder->start();
+    ValueLength const length = chunk.builder->size();
+    ValueLength const base = _buffer.size();
+    for (ValueLength offset = 0; offset < length; offset += Slice(p + offset).byteSize()) {
+      _offsets.push_back(base + offset);
+    }
+    _buffer.append(p, length);
+  }
+  return _offsets.size();
+}
+
+void BatchParser::toArray(Builder& builder) const {
+  builder.openArray();
+  for (auto const& offset : _offsets) {
+    builder.add(Slice(_buffer.data() + offset));
+  }
+  builder.close();
+}
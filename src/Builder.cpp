@@ -22,6 +22,7 @@
 /// @author Jan Steemann
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <array>
 #include <unordered_set>
 
@@ -41,14 +42,21 @@ using namespace arangodb::velocypack;
 
 namespace {
 
+// whether the Builder may pad or move as it sees fit
+inline bool isFlexible(Options const* options) noexcept {
+  return options->paddingBehavior == Options::PaddingBehavior::Flexible ||
+         options->paddingBehavior == Options::PaddingBehavior::Adaptive;
+}
+
 // checks whether a memmove operation is allowed to get rid of the padding
+template <typename T>
 bool isAllowedToMemmove(Options const* options, uint8_t const* start, 
-                        std::vector<ValueLength> const& index, ValueLength offsetSize) {
+                        T const* index, std::size_t size, ValueLength offsetSize) {
   VELOCYPACK_ASSERT(offsetSize == 1 || offsetSize == 2);
 
   if (options->paddingBehavior == Options::PaddingBehavior::NoPadding || 
-      (offsetSize == 1 && options->paddingBehavior == Options::PaddingBehavior::Flexible)) {
-    std::size_t const n = (std::min)(std::size_t(8 - 2 * offsetSize), index.size());
+      (offsetSize == 1 && ::isFlexible(options))) {
+    std::size_t const n = (std::min)(std::size_t(8 - 2 * offsetSize), size);
     for (std::size_t i = 0; i < n; i++) {
       if (start[index[i]] == 0x00) {
         return false;
@@ -60,6 +68,32 @@ bool isAllowedToMemmove(Options const* options, uint8_t const* start,
   return false;
 }
 
+// whether an Array of byte size size needs an index table, because its
+// members are not all of the same byte size
+template <typename T>
+bool needsIndexTable(ValueLength size, T const* index, std::size_t n) {
+  if (n == 1) {
+    // just one array entry
+    return false;
+  }
+  if (size - index[0] != n * (index[1] - index[0])) {
+    return true;
+  }
+  // In this case it could be that all entries have the same length
+  // and we do not need an offset table at all:
+  ValueLength const subLen = index[1] - index[0];
+  if (size - index[n - 1] != subLen) {
+    return true;
+  }
+  for (std::size_t i = 1; i < n - 1; i++) {
+    if (index[i + 1] - index[i] != subLen) {
+      // different lengths
+      return true;
+    }
+  }
+  return false;
+}
+
 uint8_t determineArrayType(bool needIndexTable, ValueLength offsetSize) {
   uint8_t type;
   // Now build the table:
@@ -86,6 +120,10 @@ struct SortEntry {
   uint8_t const* nameStart;
   uint64_t nameSize;
   uint64_t offset;
+  // the first 8 bytes of the name in big-endian order, padded with
+  // zero bytes. comparing two prefixes as integers gives the same
+  // result as comparing the names, unless the prefixes are equal
+  uint64_t prefix;
 };
 
 // minimum allocation done for the sortEntries vector
@@ -93,6 +131,88 @@ struct SortEntry {
 // reallocations
 constexpr size_t minSortEntriesAllocation = 32;
 
+// from this number of index entries on, sortObjectIndexLong uses a
+// radix sort on the name prefixes
+constexpr size_t radixSortThreshold = 256;
+
+// buckets with at most this many entries are not radix sorted further
+constexpr size_t radixSortBucketCutoff = 32;
+
+uint64_t namePrefix(uint8_t const* name, uint64_t size) noexcept {
+  uint64_t prefix = 0;
+  std::size_t const n = static_cast<std::size_t>((std::min)(size, uint64_t(8)));
+  for (std::size_t i = 0; i < n; ++i) {
+    prefix |= static_cast<uint64_t>(name[i]) << (56 - 8 * i);
+  }
+  return prefix;
+}
+
+// return true iff a < b:
+inline bool sortEntryLess(SortEntry const& a, SortEntry const& b) {
+  if (a.prefix != b.prefix) {
+    return a.prefix < b.prefix;
+  }
+  uint64_t sizea = a.nameSize;
+  uint64_t sizeb = b.nameSize;
+  if (sizea <= 8 || sizeb <= 8) {
+    // the prefixes cover at least one of the names completely
+    return sizea < sizeb;
+  }
+  std::size_t const compareLength = checkOverflow((std::min)(sizea, sizeb));
+  int res = memcmp(a.nameStart + 8, b.nameStart + 8, compareLength - 8);
+
+  return (res < 0 || (res == 0 && sizea < sizeb));
+}
+
+// in-place MSD radix sort (American flag sort) of the entries by the
+// prefix byte at position depth, then recursively by the following
+// prefix bytes. small buckets and entries with identical prefixes are
+// finished off with a comparison sort
+void radixSortEntries(SortEntry* begin, SortEntry* end, unsigned depth) {
+  std::size_t const n = static_cast<std::size_t>(end - begin);
+  if (n <= radixSortBucketCutoff || depth == 8) {
+    std::sort(begin, end, sortEntryLess);
+    return;
+  }
+
+  unsigned const shift = 56 - 8 * depth;
+  std::array<std::size_t, 256> counts;
+  counts.fill(0);
+  for (SortEntry const* e = begin; e != end; ++e) {
+    ++counts[(e->prefix >> shift) & 0xff];
+  }
+
+  std::array<std::size_t, 256> heads;
+  std::array<std::size_t, 256> tails;
+  std::size_t sum = 0;
+  for (std::size_t i = 0; i < 256; ++i) {
+    heads[i] = sum;
+    sum += counts[i];
+    tails[i] = sum;
+  }
+
+  // move every entry into its bucket
+  for (std::size_t i = 0; i < 256; ++i) {
+    while (heads[i] < tails[i]) {
+      SortEntry e = begin[heads[i]];
+      std::size_t bucket = (e.prefix >> shift) & 0xff;
+      while (bucket != i) {
+        std::swap(e, begin[heads[bucket]++]);
+        bucket = (e.prefix >> shift) & 0xff;
+      }
+      begin[heads[i]++] = e;
+    }
+  }
+
+  std::size_t start = 0;
+  for (std::size_t i = 0; i < 256; ++i) {
+    if (counts[i] > 1) {
+      radixSortEntries(begin + start, begin + start + counts[i], depth + 1);
+    }
+    start += counts[i];
+  }
+}
+
 
 #ifndef VELOCYPACK_NO_THREADLOCALS
 
@@ -130,6 +250,26 @@ uint8_t const* findAttrName(uint8_t const* base, uint64_t& len) {
   return findAttrName(arangodb::velocypack::Slice(base).makeKey().start(), len);
 }
 
+#ifdef VELOCYPACK_DEBUG
+// whether the attribute names at the offsets are in the order that
+// sortObjectIndex() establishes. used to check closePresorted()
+template <typename T>
+bool isObjectIndexSorted(uint8_t const* objBase, T const* offsets,
+                         std::size_t n) {
+  for (std::size_t i = 1; i < n; ++i) {
+    uint64_t lena;
+    uint64_t lenb;
+    uint8_t const* aa = findAttrName(objBase + offsets[i - 1], lena);
+    uint8_t const* bb = findAttrName(objBase + offsets[i], lenb);
+    int c = memcmp(aa, bb, checkOverflow((std::min)(lena, lenb)));
+    if (c > 0 || (c == 0 && lena > lenb)) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
 bool checkAttributeUniquenessUnsortedBrute(ObjectIterator& it) {
   std::array<StringRef, LinearAttributeUniquenessCutoff> keys;
 
@@ -187,6 +327,25 @@ Builder::Builder(Options const* options)
         _bufferPtr(_buffer.get()),
         _start(_bufferPtr->data()),
         _pos(0),
+        _indexesAreWide(false),
+        _keyWritten(false),
+        options(options) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+}
+  
+// create an empty Builder that allocates from the resource
+Builder::Builder(MemoryResource& resource, Options const* options)
+      : _buffer(std::allocate_shared<Buffer<uint8_t>>(
+            ResourceAllocator<Buffer<uint8_t>>(&resource), &resource)),
+        _bufferPtr(_buffer.get()),
+        _start(_bufferPtr->data()),
+        _pos(0),
+        _stack(ResourceAllocator<CompoundInfo>(&resource)),
+        _indexes(ResourceAllocator<uint32_t>(&resource)),
+        _wideIndexes(ResourceAllocator<ValueLength>(&resource)),
+        _indexesAreWide(false),
         _keyWritten(false),
         options(options) {
   if (VELOCYPACK_UNLIKELY(options == nullptr)) {
@@ -200,6 +359,7 @@ Builder::Builder(std::shared_ptr<Buffer<uint8_t>> const& buffer, Options const*
         _bufferPtr(_buffer.get()), 
         _start(nullptr),
         _pos(0), 
+        _indexesAreWide(false),
         _keyWritten(false), 
         options(options) {
   if (VELOCYPACK_UNLIKELY(_bufferPtr == nullptr)) {
@@ -219,6 +379,7 @@ Builder::Builder(Buffer<uint8_t>& buffer, Options const* options)
       : _bufferPtr(&buffer), 
         _start(_bufferPtr->data()),
         _pos(buffer.size()), 
+        _indexesAreWide(false),
         _keyWritten(false), 
         options(options) {
 
@@ -238,7 +399,9 @@ Builder::Builder(Builder const& that)
         _start(nullptr),
         _pos(that._pos),
         _stack(that._stack),
-        _index(that._index),
+        _indexes(that._indexes),
+        _wideIndexes(that._wideIndexes),
+        _indexesAreWide(that._indexesAreWide),
         _keyWritten(that._keyWritten),
         options(that.options) {
   VELOCYPACK_ASSERT(options != nullptr);
@@ -271,7 +434,9 @@ Builder& Builder::operator=(Builder const& that) {
     }
     _pos = that._pos;
     _stack = that._stack;
-    _index = that._index;
+    _indexes = that._indexes;
+    _wideIndexes = that._wideIndexes;
+    _indexesAreWide = that._indexesAreWide;
     _keyWritten = that._keyWritten;
     options = that.options;
   }
@@ -285,7 +450,9 @@ Builder::Builder(Builder&& that) noexcept
       _start(nullptr),
       _pos(that._pos),
       _stack(std::move(that._stack)),
-      _index(std::move(that._index)),
+      _indexes(std::move(that._indexes)),
+      _wideIndexes(std::move(that._wideIndexes)),
+      _indexesAreWide(that._indexesAreWide),
       _keyWritten(that._keyWritten),
       options(that.options) {
   
@@ -317,7 +484,9 @@ Builder& Builder::operator=(Builder&& that) noexcept {
     }
     _pos = that._pos;
     _stack = std::move(that._stack);
-    _index = std::move(that._index);
+    _indexes = std::move(that._indexes);
+    _wideIndexes = std::move(that._wideIndexes);
+    _indexesAreWide = that._indexesAreWide;
     _keyWritten = that._keyWritten;
     options = that.options;
     VELOCYPACK_ASSERT(that._buffer == nullptr);
@@ -344,10 +513,10 @@ std::string Builder::toJson() const {
   return buffer;
 }
   
-void Builder::sortObjectIndexShort(uint8_t* objBase,
-                                   std::vector<ValueLength>& offsets) const {
-  std::sort(offsets.begin(), offsets.end(), [objBase](ValueLength const& a, 
-                                                      ValueLength const& b) {
+template <typename T>
+void Builder::sortObjectIndexShort(uint8_t* objBase, T* offsets,
+                                   std::size_t n) const {
+  auto cmp = [objBase](T const& a, T const& b) {
     uint8_t const* aa = objBase + a;
     uint8_t const* bb = objBase + b;
     if (*aa >= 0x40 && *aa <= 0xbe && *bb >= 0x40 && *bb <= 0xbe) {
@@ -364,11 +533,15 @@ void Builder::sortObjectIndexShort(uint8_t* objBase,
       int c = memcmp(aa, bb, checkOverflow(m));
       return (c < 0 || (c == 0 && lena < lenb));
     }
-  });
+  };
+  if (!std::is_sorted(offsets, offsets + n, cmp)) {
+    std::sort(offsets, offsets + n, cmp);
+  }
 }
 
-void Builder::sortObjectIndexLong(uint8_t* objBase,
-                                  std::vector<ValueLength>& offsets) {
+template <typename T>
+void Builder::sortObjectIndexLong(uint8_t* objBase, T* offsets,
+                                  std::size_t n) {
 #ifndef VELOCYPACK_NO_THREADLOCALS
   std::unique_ptr<std::vector<SortEntry>>& tmp = ::sortEntries;
 
@@ -383,53 +556,60 @@ void Builder::sortObjectIndexLong(uint8_t* objBase,
   std::unique_ptr<std::vector<SortEntry>> tmp(new std::vector<SortEntry>());
 #endif
 
-  std::size_t const n = offsets.size();
   VELOCYPACK_ASSERT(n > 1);
   tmp->reserve(std::max(::minSortEntriesAllocation, n));
+  bool sorted = true;
   for (std::size_t i = 0; i < n; i++) {
     SortEntry e;
     e.offset = offsets[i];
     e.nameStart = ::findAttrName(objBase + e.offset, e.nameSize);
+    e.prefix = ::namePrefix(e.nameStart, e.nameSize);
+    if (sorted && i > 0 && ::sortEntryLess(e, tmp->back())) {
+      sorted = false;
+    }
     tmp->push_back(e);
   }
   VELOCYPACK_ASSERT(tmp->size() == n);
-  std::sort(tmp->begin(), tmp->end(), [](SortEntry const& a,
-                                         SortEntry const& b)
-#ifdef VELOCYPACK_64BIT
-    noexcept
-#endif
-  {
-    // return true iff a < b:
-    uint64_t sizea = a.nameSize;
-    uint64_t sizeb = b.nameSize;
-    std::size_t const compareLength = checkOverflow((std::min)(sizea, sizeb));
-    int res = memcmp(a.nameStart, b.nameStart, compareLength);
-
-    return (res < 0 || (res == 0 && sizea < sizeb));
-  });
+  if (sorted) {
+    // keys were added in sorted order already
+    return;
+  }
+  if (n >= ::radixSortThreshold) {
+    ::radixSortEntries(tmp->data(), tmp->data() + n, 0);
+  } else {
+    std::sort(tmp->begin(), tmp->end(), ::sortEntryLess);
+  }
 
   // copy back the sorted offsets
   for (std::size_t i = 0; i < n; i++) {
-    offsets[i] = (*tmp)[i].offset;
+    offsets[i] = static_cast<T>((*tmp)[i].offset);
+  }
+}
+
+template <typename T>
+void Builder::sortObjectIndex(uint8_t* objBase, T* offsets, std::size_t n) {
+  if (n > 32) {
+    sortObjectIndexLong(objBase, offsets, n);
+  } else {
+    sortObjectIndexShort(objBase, offsets, n);
   }
 }
 
 Builder& Builder::closeEmptyArrayOrObject(ValueLength tos, bool isArray) {
   // empty Array or Object
   _start[tos] = (isArray ? 0x01 : 0x0a);
-  VELOCYPACK_ASSERT(_pos == tos + 9);
-  rollback(8); // no bytelength and number subvalues needed
-  _stack.pop_back();
-  // Intentionally leave _index[depth] intact to avoid future allocs!
+  VELOCYPACK_ASSERT(_pos == tos + 1 + _stack.back().headRoom);
+  rollback(_stack.back().headRoom); // no bytelength and number subvalues needed
+  popCompound();
   return *this;
 }
 
 bool Builder::closeCompactArrayOrObject(ValueLength tos, bool isArray,
-                                        std::vector<ValueLength> const& index) {
+                                        std::size_t n) {
 
   // use compact notation
   ValueLength nLen =
-      getVariableValueLength(static_cast<ValueLength>(index.size()));
+      getVariableValueLength(static_cast<ValueLength>(n));
   VELOCYPACK_ASSERT(nLen > 0);
   ValueLength byteSize = _pos - (tos + 8) + nLen;
   VELOCYPACK_ASSERT(byteSize > 0);
@@ -449,6 +629,7 @@ bool Builder::closeCompactArrayOrObject(ValueLength tos, bool isArray,
     if (_pos > (tos + 9)) {
       ValueLength len = _pos - (tos + 9);
       memmove(_start + tos + targetPos, _start + tos + 9, checkOverflow(len));
+      _memmoveBytes += len;
     }
 
     // store byte length
@@ -460,59 +641,31 @@ bool Builder::closeCompactArrayOrObject(ValueLength tos, bool isArray,
       reserve(nLen);
     }
     storeVariableValueLength<true>(_start + tos + byteSize - 1,
-                                   static_cast<ValueLength>(index.size()));
+                                   static_cast<ValueLength>(n));
 
     rollback(8);
     advance(nLen + bLen);
 
-    _stack.pop_back();
+    popCompound();
     return true;
   }
   return false;
 }
 
-Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
-  VELOCYPACK_ASSERT(!index.empty());
-
-  bool needIndexTable = true;
-  bool needNrSubs = true;
-
-  if (index.size() == 1) {
-    // just one array entry
-    needIndexTable = false;
-    needNrSubs = false;
-  } else if ((_pos - tos) - index[0] == index.size() * (index[1] - index[0])) {
-    // In this case it could be that all entries have the same length
-    // and we do not need an offset table at all:
-    bool buildIndexTable = false;
-    ValueLength const subLen = index[1] - index[0];
-    if ((_pos - tos) - index[index.size() - 1] != subLen) {
-      buildIndexTable = true;
-    } else {
-      for (std::size_t i = 1; i < index.size() - 1; i++) {
-        if (index[i + 1] - index[i] != subLen) {
-          // different lengths
-          buildIndexTable = true;
-          break;
-        }
-      }
-    }
-        
-    if (!buildIndexTable) {
-      needIndexTable = false;
-      needNrSubs = false;
-    }
-  }
+template <typename T>
+Builder& Builder::closeArray(ValueLength tos, T* index, std::size_t n) {
+  VELOCYPACK_ASSERT(n > 0);
 
-  VELOCYPACK_ASSERT(needIndexTable == needNrSubs);
+  bool const needIndexTable = ::needsIndexTable(_pos - tos, index, n);
+  bool const needNrSubs = needIndexTable;
   
   // First determine byte length and its format:
   unsigned int offsetSize;
   // can be 1, 2, 4 or 8 for the byte width of the offsets,
   // the byte length and the number of subvalues:
-  bool allowMemmove = ::isAllowedToMemmove(options, _start + tos, index, 1);
+  bool allowMemmove = ::isAllowedToMemmove(options, _start + tos, index, n, 1);
   if (_pos - tos + 
-      (needIndexTable ? index.size() : 0) - 
+      (needIndexTable ? n : 0) - 
       (allowMemmove ? (needNrSubs ? 6 : 7) : 0) <= 0xff) {
     // We have so far used _pos - tos bytes, including the reserved 8
     // bytes for byte length and number of subvalues. In the 1-byte number
@@ -520,15 +673,15 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
     // for the index table
     offsetSize = 1;
   } else {
-    allowMemmove = ::isAllowedToMemmove(options, _start + tos, index, 2);
+    allowMemmove = ::isAllowedToMemmove(options, _start + tos, index, n, 2);
     if (_pos - tos + 
-        (needIndexTable ? 2 * index.size() : 0) - 
+        (needIndexTable ? 2 * n : 0) - 
         (allowMemmove ? (needNrSubs ? 4 : 6) : 0) <= 0xffff) {
       offsetSize = 2;
     } else {
       allowMemmove = false;
       if (_pos - tos + 
-          (needIndexTable ? 4 * index.size() : 0) <= 0xffffffffu) {
+          (needIndexTable ? 4 * n : 0) <= 0xffffffffu) {
         offsetSize = 4;
       } else {
         offsetSize = 8;
@@ -564,11 +717,11 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
     if (_pos > (tos + 9)) {
       ValueLength len = _pos - (tos + 9);
       memmove(_start + tos + targetPos, _start + tos + 9, checkOverflow(len));
+      _memmoveBytes += len;
     }
     ValueLength const diff = 9 - targetPos;
     rollback(diff);
     if (needIndexTable) {
-      std::size_t const n = index.size();
       for (std::size_t i = 0; i < n; i++) {
         index[i] -= diff;
       }
@@ -577,10 +730,10 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
 
   // Now build the table:
   if (needIndexTable) {
-    reserve(offsetSize * index.size() + (offsetSize == 8 ? 8 : 0));
+    reserve(offsetSize * n + (offsetSize == 8 ? 8 : 0));
     ValueLength tableBase = _pos;
-    advance(offsetSize * index.size());
-    for (std::size_t i = 0; i < index.size(); i++) {
+    advance(offsetSize * n);
+    for (std::size_t i = 0; i < n; i++) {
       uint64_t x = index[i];
       for (std::size_t j = 0; j < offsetSize; j++) {
         _start[tableBase + offsetSize * i + j] = x & 0xff;
@@ -592,7 +745,7 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
   // Finally fix the byte width at tthe end:
   if (offsetSize == 8 && needNrSubs) {
     reserve(8);
-    appendLengthUnchecked<8>(index.size());
+    appendLengthUnchecked<8>(n);
   }
 
   // Fix the byte length in the beginning:
@@ -603,49 +756,209 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
   }
 
   if (offsetSize < 8 && needNrSubs) {
-    x = index.size();
+    x = n;
     for (unsigned int i = offsetSize + 1; i <= 2 * offsetSize; i++) {
       _start[tos + i] = x & 0xff;
       x >>= 8;
     }
   }
 
-  // Now the array or object is complete, we pop a ValueLength
-  // off the _stack:
-  _stack.pop_back();
-  // Intentionally leave _index[depth] intact to avoid future allocs!
+  // Now the array or object is complete, we pop it off the _stack:
+  learnHeadRoom(2 * offsetSize);
+  popCompound();
   return *this;
 }
 
-Builder& Builder::close() {
-  if (VELOCYPACK_UNLIKELY(isClosed())) {
-    throw Exception(Exception::BuilderNeedOpenCompound);
+template <typename T>
+bool Builder::closeInHeadRoom(ValueLength tos, T* index, std::size_t n,
+                              bool compact, bool sortIndex) {
+  ValueLength const headRoom = _stack.back().headRoom;
+  VELOCYPACK_ASSERT(headRoom < 8);
+  bool const isArray = (_start[tos] == 0x06 || _start[tos] == 0x13);
+  bool const noPadding =
+      (options->paddingBehavior == Options::PaddingBehavior::NoPadding);
+  ValueLength const data = _pos - (tos + 1 + headRoom);
+
+  if (compact) {
+    ValueLength const nLen = getVariableValueLength(static_cast<ValueLength>(n));
+    ValueLength const byteSize = 1 + data + nLen;
+    ValueLength bLen = getVariableValueLength(byteSize);
+    if (getVariableValueLength(byteSize + bLen) != bLen) {
+      bLen += 1;
+    }
+    if (bLen > headRoom) {
+      return false;
+    }
+    // the byte length must be stored with its minimal size, so a larger
+    // head room means a move down
+    if (bLen < headRoom) {
+      moveDown(tos, headRoom - bLen);
+    } else {
+      _memmoveBytesAvoided += data;
+    }
+    _start[tos] = (isArray ? 0x13 : 0x14);
+    storeVariableValueLength<false>(_start + tos + 1, byteSize + bLen);
+    reserve(nLen);
+    storeVariableValueLength<true>(_start + tos + byteSize + bLen - 1,
+                                   static_cast<ValueLength>(n));
+    advance(nLen);
+
+    popCompound();
+
+    // And, if desired, check attribute uniqueness:
+    if (options->checkAttributeUniqueness && 
+        n > 1 &&
+        !checkAttributeUniqueness(Slice(_start + tos))) {
+      // duplicate attribute name!
+      throw Exception(Exception::DuplicateAttributeName);
+    }
+    return true;
+  }
+
+  if (isArray && _start[tos + index[0]] == 0x00) {
+    // a leading None value cannot be told apart from padding, so the
+    // header must be padded to 9 bytes
+    return false;
+  }
+
+  // the header must either fill the head room exactly or be padded to 9
+  // bytes, so a header shorter than the head room means a move down
+  bool const needIndexTable = !isArray || ::needsIndexTable(_pos - tos, index, n);
+  ValueLength const perOffset = (needIndexTable ? 2 : 1);
+  for (ValueLength offsetSize = 1; perOffset * offsetSize <= headRoom; offsetSize *= 2) {
+    ValueLength const diff = headRoom - perOffset * offsetSize;
+    ValueLength const byteSize =
+        _pos - tos - diff + (needIndexTable ? n * offsetSize : 0);
+    if (byteSize > (ValueLength(1) << (8 * offsetSize)) - 1) {
+      continue;
+    }
+
+    if (diff > 0) {
+      moveDown(tos, diff);
+      if (needIndexTable) {
+        for (std::size_t i = 0; i < n; i++) {
+          index[i] -= static_cast<T>(diff);
+        }
+      }
+    } else if (offsetSize == 1 || noPadding) {
+      // a 2-byte offset header would have been padded instead
+      _memmoveBytesAvoided += data;
+    }
+
+    if (isArray) {
+      _start[tos] = ::determineArrayType(needIndexTable, offsetSize);
+    } else {
+      _start[tos] = static_cast<uint8_t>(offsetSize == 1 ? 0x0b : (offsetSize == 2 ? 0x0c : 0x0d));
+      if (n >= 2 && sortIndex) {
+        sortObjectIndex(_start + tos, index, n);
+      }
+      VELOCYPACK_ASSERT(sortIndex || ::isObjectIndexSorted(_start + tos, index, n));
+    }
+
+    if (needIndexTable) {
+      reserve(offsetSize * n);
+      ValueLength tableBase = _pos;
+      advance(offsetSize * n);
+      for (std::size_t i = 0; i < n; ++i) {
+        uint64_t x = index[i];
+        for (std::size_t j = 0; j < offsetSize; ++j) {
+          _start[tableBase + offsetSize * i + j] = x & 0xff;
+          x >>= 8;
+        }
+      }
+    }
+    VELOCYPACK_ASSERT(_pos - tos == byteSize);
+
+    ValueLength x = byteSize;
+    for (ValueLength i = 1; i <= offsetSize; i++) {
+      _start[tos + i] = x & 0xff;
+      x >>= 8;
+    }
+    if (needIndexTable) {
+      x = n;
+      for (ValueLength i = offsetSize + 1; i <= 2 * offsetSize; i++) {
+        _start[tos + i] = x & 0xff;
+        x >>= 8;
+      }
+    }
+
+    // And, if desired, check attribute uniqueness:
+    if (!isArray &&
+        options->checkAttributeUniqueness && 
+        n > 1 &&
+        !checkAttributeUniqueness(Slice(_start + tos))) {
+      // duplicate attribute name!
+      throw Exception(Exception::DuplicateAttributeName);
+    }
+
+    learnHeadRoom(perOffset * offsetSize);
+    popCompound();
+    return true;
   }
-  ValueLength tos = _stack.back();
+  return false;
+}
+
+void Builder::moveDown(ValueLength tos, ValueLength diff) {
+  CompoundInfo& info = _stack.back();
+  ValueLength const from = tos + 1 + info.headRoom;
+  ValueLength const len = _pos - from;
+  memmove(_start + from - diff, _start + from, checkOverflow(len));
+  rollback(diff);
+  info.headRoom = static_cast<uint8_t>(info.headRoom - diff);
+  _memmoveBytes += len;
+}
+
+template <typename T>
+void Builder::growHeadRoom(ValueLength tos, T* index, std::size_t n) {
+  CompoundInfo& info = _stack.back();
+  ValueLength const diff = 8 - info.headRoom;
+  ValueLength const len = _pos - (tos + 1 + info.headRoom);
+  reserve(diff);
+  memmove(_start + tos + 9, _start + tos + 1 + info.headRoom, checkOverflow(len));
+  memset(_start + tos + 1 + info.headRoom, 0, checkOverflow(diff));
+  advance(diff);
+  for (std::size_t i = 0; i < n; ++i) {
+    index[i] += static_cast<T>(diff);
+  }
+  info.headRoom = 8;
+  _memmoveBytes += len;
+}
+
+template <typename T>
+Builder& Builder::closeCompound(T* index, std::size_t n, bool sortIndex) {
+  ValueLength tos = _stack.back().startPos;
   uint8_t const head = _start[tos];
 
   VELOCYPACK_ASSERT(head == 0x06 || head == 0x0b || head == 0x13 ||
                     head == 0x14);
 
   bool const isArray = (head == 0x06 || head == 0x13);
-  std::vector<ValueLength>& index = _index[_stack.size() - 1];
-
-  if (index.empty()) {
+  if (n == 0) {
     closeEmptyArrayOrObject(tos, isArray);
     return *this;
   }
 
-  // From now on index.size() > 0
-  VELOCYPACK_ASSERT(index.size() > 0);
+  // From now on n > 0
+  VELOCYPACK_ASSERT(n > 0);
 
   // check if we can use the compact Array / Object format
-  if (head == 0x13 || head == 0x14 ||
-      (head == 0x06 && options->buildUnindexedArrays) ||
-      (head == 0x0b && (options->buildUnindexedObjects || index.size() == 1))) {
-    if (closeCompactArrayOrObject(tos, isArray, index)) {
+  bool const compact = (head == 0x13 || head == 0x14 ||
+                        (head == 0x06 && options->buildUnindexedArrays) ||
+                        (head == 0x0b && (options->buildUnindexedObjects || n == 1)));
+
+  if (_stack.back().headRoom < 8) {
+    if (closeInHeadRoom(tos, index, n, compact, sortIndex)) {
+      return *this;
+    }
+    // the header does not fit in front of the members
+    growHeadRoom(tos, index, n);
+  }
+
+  if (compact) {
+    if (closeCompactArrayOrObject(tos, isArray, n)) {
       // And, if desired, check attribute uniqueness:
       if (options->checkAttributeUniqueness && 
-          index.size() > 1 &&
+          n > 1 &&
           !checkAttributeUniqueness(Slice(_start + tos))) {
         // duplicate attribute name!
         throw Exception(Exception::DuplicateAttributeName);
@@ -656,7 +969,7 @@ Builder& Builder::close() {
   }
 
   if (isArray) {
-    closeArray(tos, index);
+    closeArray(tos, index, n);
     return *this;
   }
 
@@ -669,7 +982,7 @@ Builder& Builder::close() {
   unsigned int offsetSize = 8;
   // can be 1, 2, 4 or 8 for the byte width of the offsets,
   // the byte length and the number of subvalues:
-  if (_pos - tos + index.size() - 6 <= 0xff) {
+  if (_pos - tos + n - 6 <= 0xff) {
     // We have so far used _pos - tos bytes, including the reserved 8
     // bytes for byte length and number of subvalues. In the 1-byte number
     // case we would win back 6 bytes but would need one byte per subvalue
@@ -678,38 +991,39 @@ Builder& Builder::close() {
     // One could move down things in the offsetSize == 2 case as well,
     // since we only need 4 bytes in the beginning. However, saving these
     // 4 bytes has been sacrificed on the Altar of Performance.
-  } else if (_pos - tos + 2 * index.size() <= 0xffff) {
+  } else if (_pos - tos + 2 * n <= 0xffff) {
     offsetSize = 2;
-  } else if (_pos - tos + 4 * index.size() <= 0xffffffffu) {
+  } else if (_pos - tos + 4 * n <= 0xffffffffu) {
     offsetSize = 4;
   }
     
   if (offsetSize < 4 &&
       (options->paddingBehavior == Options::PaddingBehavior::NoPadding ||
-       (offsetSize == 1 && options->paddingBehavior == Options::PaddingBehavior::Flexible))) {
+       (offsetSize == 1 && ::isFlexible(options)))) {
     // Maybe we need to move down data:
     ValueLength targetPos = 1 + 2 * offsetSize;
     if (_pos > (tos + 9)) {
       ValueLength len = _pos - (tos + 9);
       memmove(_start + tos + targetPos, _start + tos + 9, checkOverflow(len));
+      _memmoveBytes += len;
     }
     ValueLength const diff = 9 - targetPos;
     rollback(diff);
-    std::size_t const n = index.size();
     for (std::size_t i = 0; i < n; i++) {
       index[i] -= diff;
     }
   }
 
   // Now build the table:
-  reserve(offsetSize * index.size() + (offsetSize == 8 ? 8 : 0));
+  reserve(offsetSize * n + (offsetSize == 8 ? 8 : 0));
   ValueLength tableBase = _pos;
-  advance(offsetSize * index.size());
+  advance(offsetSize * n);
   // Object
-  if (index.size() >= 2) {
-    sortObjectIndex(_start + tos, index);
+  if (n >= 2 && sortIndex) {
+    sortObjectIndex(_start + tos, index, n);
   }
-  for (std::size_t i = 0; i < index.size(); ++i) {
+  VELOCYPACK_ASSERT(sortIndex || ::isObjectIndexSorted(_start + tos, index, n));
+  for (std::size_t i = 0; i < n; ++i) {
     uint64_t x = index[i];
     for (std::size_t j = 0; j < offsetSize; ++j) {
       _start[tableBase + offsetSize * i + j] = x & 0xff;
@@ -725,7 +1039,7 @@ Builder& Builder::close() {
     } else {  // offsetSize == 8
       _start[tos] += 3;
       reserve(8);
-      appendLengthUnchecked<8>(index.size());
+      appendLengthUnchecked<8>(n);
     }
   }
 
@@ -737,7 +1051,7 @@ Builder& Builder::close() {
   }
 
   if (offsetSize < 8) {
-    x = index.size();
+    x = n;
     for (unsigned int i = offsetSize + 1; i <= 2 * offsetSize; i++) {
       _start[tos + i] = x & 0xff;
       x >>= 8;
@@ -746,35 +1060,70 @@ Builder& Builder::close() {
 
   // And, if desired, check attribute uniqueness:
   if (options->checkAttributeUniqueness && 
-      index.size() > 1 &&
+      n > 1 &&
       !checkAttributeUniqueness(Slice(_start + tos))) {
     // duplicate attribute name!
     throw Exception(Exception::DuplicateAttributeName);
   }
 
-  // Now the array or object is complete, we pop a ValueLength
-  // off the _stack:
-  _stack.pop_back();
-  // Intentionally leave _index[depth] intact to avoid future allocs!
+  // Now the array or object is complete, we pop it off the _stack:
+  learnHeadRoom(2 * offsetSize);
+  popCompound();
       
   return *this;
 }
 
+Builder& Builder::close(bool sortIndex) {
+  if (VELOCYPACK_UNLIKELY(isClosed())) {
+    throw Exception(Exception::BuilderNeedOpenCompound);
+  }
+  CompoundInfo const& tos = _stack.back();
+  if (VELOCYPACK_UNLIKELY(!_indexesAreWide && tos.headRoom < 8 &&
+                          _pos - tos.startPos > 0xffffffffu - 8)) {
+    // moving the members up could overflow their offsets
+    makeIndexesWide();
+  }
+  std::size_t const indexStartPos = tos.indexStartPos;
+  if (VELOCYPACK_LIKELY(!_indexesAreWide)) {
+    return closeCompound(_indexes.data() + indexStartPos,
+                         _indexes.size() - indexStartPos, sortIndex);
+  }
+  return closeCompound(_wideIndexes.data() + indexStartPos,
+                       _wideIndexes.size() - indexStartPos, sortIndex);
+}
+
+void Builder::makeIndexesWide() {
+  VELOCYPACK_ASSERT(!_indexesAreWide);
+  _wideIndexes.assign(_indexes.begin(), _indexes.end());
+  _indexes.clear();
+  _indexesAreWide = true;
+}
+
+void Builder::reportAddWide(ValueLength pos) {
+  if (!_indexesAreWide) {
+    // an offset does not fit into 32 bits anymore. from now on, keep
+    // all offsets as 64 bit values
+    makeIndexesWide();
+  }
+  // avoid same position being added several times
+  if (_wideIndexes.size() == _stack.back().indexStartPos ||
+      _wideIndexes.back() != pos) {
+    _wideIndexes.push_back(pos);
+  }
+}
+
 // checks whether an Object value has a specific key attribute
 bool Builder::hasKey(std::string const& key) const {
   if (VELOCYPACK_UNLIKELY(_stack.empty())) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
-  ValueLength const& tos = _stack.back();
+  ValueLength const tos = _stack.back().startPos;
   if (VELOCYPACK_UNLIKELY(_start[tos] != 0x0b && _start[tos] != 0x14)) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
-  std::vector<ValueLength> const& index = _index[_stack.size() - 1];
-  if (index.empty()) {
-    return false;
-  }
-  for (std::size_t i = 0; i < index.size(); ++i) {
-    Slice s(_start + tos + index[i]);
+  std::size_t const n = indexesSize();
+  for (std::size_t i = _stack.back().indexStartPos; i < n; ++i) {
+    Slice s(_start + tos + indexAt(i));
     if (s.makeKey().isEqualString(key)) {
       return true;
     }
@@ -787,16 +1136,13 @@ Slice Builder::getKey(std::string const& key) const {
   if (VELOCYPACK_UNLIKELY(_stack.empty())) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
-  ValueLength const tos = _stack.back();
+  ValueLength const tos = _stack.back().startPos;
   if (_start[tos] != 0x0b && _start[tos] != 0x14) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
-  std::vector<ValueLength> const& index = _index[_stack.size() - 1];
-  if (index.empty()) {
-    return Slice();
-  }
-  for (std::size_t i = 0; i < index.size(); ++i) {
-    Slice s(_start + tos + index[i]);
+  std::size_t const n = indexesSize();
+  for (std::size_t i = _stack.back().indexStartPos; i < n; ++i) {
+    Slice s(_start + tos + indexAt(i));
     if (s.makeKey().isEqualString(key)) {
       return Slice(s.start() + s.byteSize());
     }
@@ -973,18 +1319,7 @@ uint8_t* Builder::set(uint64_t tag, Value const& item) {
             Exception::BuilderUnexpectedValue,
             "Must give a string or char const* for ValueType::String");
       }
-      if (size <= 126) {
-        // short string
-        reserve(1 + size);
-        appendByteUnchecked(static_cast<uint8_t>(0x40 + size));
-      } else {
-        // long string
-        reserve(1 + 8 + size);
-        appendByteUnchecked(0xbf);
-        appendLengthUnchecked<8>(size);
-      }
-      memcpy(_start + _pos, p, size);
-      advance(size);
+      appendString(p, size);
       break;
     }
     case ValueType::Array: {
@@ -1246,7 +1581,7 @@ uint8_t* Builder::add(ObjectIterator&& sub) {
   if (VELOCYPACK_UNLIKELY(_stack.empty())) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
-  ValueLength& tos = _stack.back();
+  ValueLength const tos = _stack.back().startPos;
   if (VELOCYPACK_UNLIKELY(_start[tos] != 0x0b && _start[tos] != 0x14)) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
@@ -1269,7 +1604,7 @@ uint8_t* Builder::add(ArrayIterator&& sub) {
   if (VELOCYPACK_UNLIKELY(_stack.empty())) {
     throw Exception(Exception::BuilderNeedOpenArray);
   }
-  ValueLength& tos = _stack.back();
+  ValueLength const tos = _stack.back().startPos;
   if (VELOCYPACK_UNLIKELY(_start[tos] != 0x06 && _start[tos] != 0x13)) {
     throw Exception(Exception::BuilderNeedOpenArray);
   }
@@ -1281,4 +1616,74 @@ uint8_t* Builder::add(ArrayIterator&& sub) {
   return _start + oldPos;
 }
 
+uint8_t* Builder::addSlices(Slice const* slices, std::size_t n) {
+  checkOpenArray();
+  ValueLength total = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    total += slices[i].byteSize();
+  }
+  reserve(total);
+
+  auto const oldPos = _pos;
+  for (std::size_t i = 0; i < n; ++i) {
+    ValueLength const size = slices[i].byteSize();
+    reportAdd();
+    memcpy(_start + _pos, slices[i].start(), checkOverflow(size));
+    advance(size);
+  }
+  return _start + oldPos;
+}
+
+uint8_t* Builder::addSequence(uint8_t const* data, ValueLength size) {
+  checkOpenArray();
+  // the values must exactly fill the data
+  ValueLength offset = 0;
+  while (offset < size) {
+    offset += Slice(data + offset).byteSize();
+  }
+  if (VELOCYPACK_UNLIKELY(offset != size)) {
+    throw Exception(Exception::BuilderUnexpectedValue,
+                    "Sequence does not end with a complete value");
+  }
+  reserve(size);
+
+  auto const oldPos = _pos;
+  memcpy(_start + _pos, data, checkOverflow(size));
+  while (_pos < oldPos + size) {
+    reportAdd();
+    advance(Slice(_start + _pos).byteSize());
+  }
+  return _start + oldPos;
+}
+
+uint8_t* Builder::addUninitialized(ValueLength const* sizes, std::size_t n) {
+  checkOpenArray();
+  ValueLength total = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (VELOCYPACK_UNLIKELY(sizes[i] == 0)) {
+      throw Exception(Exception::BuilderUnexpectedValue,
+                      "Value must not be empty");
+    }
+    total += sizes[i];
+  }
+  reserve(total);
+
+  auto const oldPos = _pos;
+  for (std::size_t i = 0; i < n; ++i) {
+    reportAdd();
+    advance(sizes[i]);
+  }
+  return _start + oldPos;
+}
+
+void Builder::checkOpenArray() const {
+  if (VELOCYPACK_UNLIKELY(_stack.empty())) {
+    throw Exception(Exception::BuilderNeedOpenArray);
+  }
+  ValueLength const tos = _stack.back().startPos;
+  if (VELOCYPACK_UNLIKELY(_start[tos] != 0x06 && _start[tos] != 0x13)) {
+    throw Exception(Exception::BuilderNeedOpenArray);
+  }
+}
+
 static_assert(sizeof(double) == 8, "double is not 8 bytes");
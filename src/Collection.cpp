@@ -347,12 +347,94 @@ Builder Collection::merge(Slice const& left, Slice const& right,
   return b;
 }
 
+// whether an ObjectIterator returns the members of an Object in sorted
+// key order
+static bool hasSortedKeys(Slice const& slice) {
+  return slice.isSorted() || slice.length() <= 1;
+}
+
+// advances the iterator over all members with the given key
+static void skipKey(ObjectIterator& it, StringRef const& key) {
+  while (it.valid() && (*it).key.stringRef().equals(key)) {
+    it.next();
+  }
+}
+
+// merges two Objects whose members are iterated in sorted key order,
+// emitting the result members in sorted key order as well
+static void mergeSorted(Builder& builder, Slice const& left, Slice const& right,
+                        bool mergeValues, bool nullMeansRemove) {
+  builder.add(Value(ValueType::Object));
+
+  ObjectIterator l(left);
+  ObjectIterator r(right);
+  while (l.valid() && r.valid()) {
+    auto currentLeft = (*l);
+    auto currentRight = (*r);
+    auto keyLeft = currentLeft.key.stringRef();
+    auto keyRight = currentRight.key.stringRef();
+    int const res = keyLeft.compare(keyRight);
+
+    if (res < 0) {
+      // use left value. like in the unsorted case, all duplicates of a
+      // key that is only in left are kept
+      builder.add(keyLeft, currentLeft.value);
+      l.next();
+    } else if (res > 0) {
+      // use right value
+      if (!nullMeansRemove || !currentRight.value.isNull()) {
+        builder.add(keyRight, currentRight.value);
+      }
+      // like in the unsorted case, the first of duplicate keys wins
+      skipKey(r, keyRight);
+    } else {
+      if (mergeValues && currentLeft.value.isObject() &&
+          currentRight.value.isObject()) {
+        // merge both values
+        builder.add(ValuePair(keyLeft, ValueType::String));
+        Collection::merge(builder, currentLeft.value, currentRight.value, true,
+                          nullMeansRemove);
+      } else if (!nullMeansRemove || !currentRight.value.isNull()) {
+        // use right value
+        builder.add(keyLeft, currentRight.value);
+      }
+      // like in the unsorted case, the right value replaces all duplicates
+      // of the left key
+      skipKey(l, keyLeft);
+      skipKey(r, keyRight);
+    }
+  }
+
+  // add remaining values that were only in left
+  while (l.valid()) {
+    auto current = (*l);
+    builder.add(current.key.stringRef(), current.value);
+    l.next();
+  }
+
+  // add remaining values that were only in right
+  while (r.valid()) {
+    auto current = (*r);
+    if (!nullMeansRemove || !current.value.isNull()) {
+      builder.add(current.key.stringRef(), current.value);
+    }
+    skipKey(r, current.key.stringRef());
+  }
+
+  builder.closePresorted();
+}
+
 Builder& Collection::merge(Builder& builder, Slice const& left, Slice const& right,
                            bool mergeValues, bool nullMeansRemove) {
   if (!left.isObject() || !right.isObject()) {
     throw Exception(Exception::InvalidValueType, "Expecting type Object");
   }
 
+  if (hasSortedKeys(left) && hasSortedKeys(right)) {
+    mergeSorted(builder, left, right, mergeValues, nullMeansRemove);
+    return builder;
+  }
+
   builder.add(Value(ValueType::Object));
 
   std::unordered_map<StringRef, Slice> rightValues;
@@ -376,6 +458,9 @@ Builder& Collection::merge(Builder& builder, Slice const& left, Slice const& rig
       if (found == rightValues.end()) {
         // use left value
         builder.add(key, current.value);
+      } else if ((*found).second.isNone()) {
+        // duplicate of a left key that was already replaced by the right
+        // value, drop it
       } else if (mergeValues && current.value.isObject() &&
                  (*found).second.isObject()) {
         // merge both values
@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/CompactIndex.h"
+#include "velocypack/Exception.h"
+
+using namespace arangodb::velocypack;
+
+CompactIndex::CompactIndex() : _start(nullptr), _byteSize(0), _head(0) {}
+
+Slice CompactIndex::at(Slice array, ValueLength index) {
+  if (VELOCYPACK_UNLIKELY(array.head() != 0x13)) {
+    return array.at(index);
+  }
+  build(array);
+  return Slice(_start + offset(index));
+}
+
+Slice CompactIndex::keyAt(Slice object, ValueLength index, bool translate) {
+  if (VELOCYPACK_UNLIKELY(object.head() != 0x14)) {
+    return object.keyAt(index, translate);
+  }
+  build(object);
+  Slice key(_start + offset(index));
+  if (translate) {
+    return key.makeKey();
+  }
+  return key;
+}
+
+Slice CompactIndex::valueAt(Slice object, ValueLength index) {
+  if (VELOCYPACK_UNLIKELY(object.head() != 0x14)) {
+    return object.valueAt(index);
+  }
+  build(object);
+  Slice key(_start + offset(index));
+  return Slice(key.start() + key.byteSize());
+}
+
+Slice CompactIndex::get(Slice object, StringRef const& attribute) {
+  if (VELOCYPACK_UNLIKELY(object.head() != 0x14)) {
+    return object.get(attribute);
+  }
+  build(object);
+
+  if (_keys.empty()) {
+    _keys.reserve(_offsets.size());
+    for (ValueLength i = 0; i < _offsets.size(); ++i) {
+      // the first occurrence of a duplicate key wins, as in Slice::get()
+      _keys.emplace(Slice(_start + _offsets[i]).makeKey().stringRef(), i);
+    }
+  }
+
+  auto it = _keys.find(attribute);
+  if (it == _keys.end()) {
+    return Slice();
+  }
+  Slice key(_start + _offsets[it->second]);
+  return Slice(key.start() + key.byteSize());
+}
+
+void CompactIndex::clear() noexcept {
+  _start = nullptr;
+  _byteSize = 0;
+  _head = 0;
+  _offsets.clear();
+  _keys.clear();
+}
+
+void CompactIndex::build(Slice container) {
+  uint8_t const* start = container.start();
+  ValueLength const end = readVariableValueLength<false>(start + 1);
+  ValueLength const n = readVariableValueLength<true>(start + end - 1);
+  if (start == _start && end == _byteSize && n == _offsets.size() &&
+      *start == _head) {
+    return;
+  }
+  clear();
+
+  bool const isObject = (container.head() == 0x14);
+
+  _offsets.reserve(checkOverflow(n));
+  ValueLength offset = 1 + getVariableValueLength(end);
+  for (ValueLength i = 0; i < n; ++i) {
+    _offsets.push_back(offset);
+    offset += Slice(start + offset).byteSize();
+    if (isObject) {
+      offset += Slice(start + offset).byteSize();
+    }
+  }
+  _start = start;
+  _byteSize = end;
+  _head = *start;
+}
+
+ValueLength CompactIndex::offset(ValueLength index) const {
+  if (VELOCYPACK_UNLIKELY(index >= _offsets.size())) {
+    throw Exception(Exception::IndexOutOfBounds);
+  }
+  return _offsets[index];
+}
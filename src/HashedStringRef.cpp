@@ -39,6 +39,7 @@ extern void* memrchr(void const* block, int c, std::size_t size);
 }
 
 HashedStringRef::HashedStringRef(Slice slice) {
+  slice = slice.resolveExternals();
   VELOCYPACK_ASSERT(slice.isString());
   ValueLength l;
   _data = slice.getString(l);
@@ -53,6 +54,7 @@ HashedStringRef::HashedStringRef(StringRef const& other) noexcept
   
 /// @brief create a HashedStringRef from a VPack slice of type String
 HashedStringRef& HashedStringRef::operator=(Slice slice) {
+  slice = slice.resolveExternals();
   VELOCYPACK_ASSERT(slice.isString());
   ValueLength l;
   _data = slice.getString(l);
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/MemoryResource.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+inline uint8_t* alignUp(uint8_t* p, std::size_t alignment) noexcept {
+  VELOCYPACK_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+  return reinterpret_cast<uint8_t*>(
+      (reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+}
+
+} // namespace
+
+void* MemoryResource::reallocate(void* p, std::size_t oldSize,
+                                 std::size_t newSize, std::size_t alignment) {
+  void* result = allocate(newSize, alignment);
+  if (p != nullptr) {
+    memcpy(result, p, (std::min)(oldSize, newSize));
+    deallocate(p, oldSize, alignment);
+  }
+  return result;
+}
+
+constexpr std::size_t ArenaMemoryResource::defaultBlockSize;
+
+ArenaMemoryResource::ArenaMemoryResource(std::size_t blockSize)
+    : ArenaMemoryResource(nullptr, 0, blockSize) {}
+
+ArenaMemoryResource::ArenaMemoryResource(void* buffer, std::size_t size,
+                                         std::size_t blockSize)
+    : _current(static_cast<uint8_t*>(buffer)),
+      _end(static_cast<uint8_t*>(buffer) + size),
+      _last(nullptr),
+      _head(nullptr),
+      _initial(static_cast<uint8_t*>(buffer)),
+      _initialSize(size),
+      _blockSize((std::max)(blockSize, std::size_t(64))),
+      _nextBlockSize(_blockSize),
+      _allocated(0),
+      _blocks(0) {}
+
+ArenaMemoryResource::~ArenaMemoryResource() {
+  release();
+  if (_head != nullptr) {
+    velocypack_free(_head);
+  }
+}
+
+void* ArenaMemoryResource::allocate(std::size_t size, std::size_t alignment) {
+  uint8_t* p = alignUp(_current, alignment);
+  if (_current == nullptr || p > _end ||
+      size > static_cast<std::size_t>(_end - p)) {
+    addBlock(size + alignment);
+    p = alignUp(_current, alignment);
+  }
+  VELOCYPACK_ASSERT(size <= static_cast<std::size_t>(_end - p));
+  _current = p + size;
+  _last = p;
+  _allocated += size;
+  return p;
+}
+
+void* ArenaMemoryResource::reallocate(void* p, std::size_t oldSize,
+                                      std::size_t newSize,
+                                      std::size_t alignment) {
+  if (p == nullptr) {
+    return allocate(newSize, alignment);
+  }
+  uint8_t* q = static_cast<uint8_t*>(p);
+  if (q == _last) {
+    if (newSize <= static_cast<std::size_t>(_end - q)) {
+      // most recent allocation: grow or shrink it in place
+      _current = q + newSize;
+      _allocated = _allocated - oldSize + newSize;
+      return p;
+    }
+  } else if (newSize <= oldSize) {
+    return p;
+  }
+  void* result = allocate(newSize, alignment);
+  memcpy(result, p, (std::min)(oldSize, newSize));
+  return result;
+}
+
+void ArenaMemoryResource::release() noexcept {
+  _allocated = 0;
+  if (_head == nullptr) {
+    resetTo(_initial, _initial + _initialSize);
+    return;
+  }
+  // keep the most recent (and largest) block for reuse
+  Block* block = _head->next;
+  while (block != nullptr) {
+    Block* next = block->next;
+    velocypack_free(block);
+    block = next;
+  }
+  _head->next = nullptr;
+  _blocks = 1;
+  uint8_t* begin = reinterpret_cast<uint8_t*>(_head) + sizeof(Block);
+  resetTo(begin, reinterpret_cast<uint8_t*>(_head) + _head->size);
+}
+
+void ArenaMemoryResource::addBlock(std::size_t minSize) {
+  if (VELOCYPACK_UNLIKELY(minSize > SIZE_MAX - sizeof(Block))) {
+    throw std::bad_alloc();
+  }
+  std::size_t size = (std::max)(_nextBlockSize, minSize + sizeof(Block));
+  Block* block = static_cast<Block*>(velocypack_malloc(size));
+  if (VELOCYPACK_UNLIKELY(block == nullptr)) {
+    throw std::bad_alloc();
+  }
+  block->next = _head;
+  block->size = size;
+  _head = block;
+  ++_blocks;
+  if (_nextBlockSize <= SIZE_MAX / 2) {
+    _nextBlockSize *= 2;
+  }
+  resetTo(reinterpret_cast<uint8_t*>(block) + sizeof(Block),
+          reinterpret_cast<uint8_t*>(block) + size);
+}
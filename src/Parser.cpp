@@ -24,14 +24,37 @@
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Projection.h"
 #include "velocypack/Value.h"
 #include "velocypack/ValueType.h"
 #include "asm-functions.h"
+#include "fast-float.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 using namespace arangodb::velocypack;
 
+namespace {
+
+// whether the byte at p[pos] is escaped by a backslash. escapedAtStart
+// tells if p[0] is escaped by a backslash preceding p
+bool isEscaped(uint8_t const* p, std::size_t pos, bool escapedAtStart) {
+  std::size_t backslashes = 0;
+  while (backslashes < pos && p[pos - backslashes - 1] == '\\') {
+    ++backslashes;
+  }
+  if (backslashes == pos && escapedAtStart) {
+    // the first backslash of the sequence is escaped itself
+    return (backslashes & 1) == 0;
+  }
+  return (backslashes & 1) == 1;
+}
+
+}  // namespace
+
 // The following function does the actual parse. It gets bytes
 // via peek, consume and reset appends the result to the Builder
 // in *_builderPtr. Errors are reported via an exception.
@@ -49,24 +72,13 @@ ValueLength Parser::parseInternal(bool multi) {
 
   ValueLength nr = 0;
   do {
-    bool haveReported = false;
-    if (!_builderPtr->_stack.empty()) {
-      ValueLength const tos = _builderPtr->_stack.back();
-      if (_builderPtr->_start[tos] == 0x0b || _builderPtr->_start[tos] == 0x14) {
-        if (!_builderPtr->_keyWritten) {
-          throw Exception(Exception::BuilderKeyMustBeString);
-        }
-        else {
-          _builderPtr->_keyWritten = false;
-        }
-      }
-      else {
-        _builderPtr->reportAdd();
-        haveReported = true;
-      }
-    }
+    bool haveReported = prepareTopLevelValue();
     try {
-      parseJson();
+      if (options->projection != nullptr) {
+        parseProjected();
+      } else {
+        parseJson();
+      }
     }
     catch (...) {
       if (haveReported) {
@@ -86,6 +98,24 @@ ValueLength Parser::parseInternal(bool multi) {
   return nr;
 }
 
+bool Parser::prepareTopLevelValue() {
+  if (_builderPtr->_stack.empty()) {
+    return false;
+  }
+  ValueLength const tos = _builderPtr->_stack.back().startPos;
+  if (_builderPtr->_start[tos] == 0x0b || _builderPtr->_start[tos] == 0x14) {
+    if (!_builderPtr->_keyWritten) {
+      throw Exception(Exception::BuilderKeyMustBeString);
+    }
+    else {
+      _builderPtr->_keyWritten = false;
+    }
+    return false;
+  }
+  _builderPtr->reportAdd();
+  return true;
+}
+
 // skips over all following whitespace tokens but does not consume the
 // byte following the whitespace
 int Parser::skipWhiteSpace(char const* err) {
@@ -147,26 +177,21 @@ void Parser::parseNumber() {
       unconsume();
     }
     if (!numberValue.isInteger) {
-      if (negative) {
-        _builderPtr->addDouble(-numberValue.doubleValue);
-      } else {
-        _builderPtr->addDouble(numberValue.doubleValue);
-      }
+      addDouble(numberValue, negative, startPos);
     } else if (negative) {
-      if (numberValue.intValue <= static_cast<uint64_t>(INT64_MAX)) {
-        _builderPtr->addInt(-static_cast<int64_t>(numberValue.intValue));
-      } else if (numberValue.intValue == toUInt64(INT64_MIN)) {
+      if (numberValue.mantissa <= static_cast<uint64_t>(INT64_MAX)) {
+        _builderPtr->addInt(-static_cast<int64_t>(numberValue.mantissa));
+      } else if (numberValue.mantissa == toUInt64(INT64_MIN)) {
         _builderPtr->addInt(INT64_MIN);
       } else {
-        _builderPtr->addDouble(-static_cast<double>(numberValue.intValue));
+        _builderPtr->addDouble(-static_cast<double>(numberValue.mantissa));
       }
     } else {
-      _builderPtr->addUInt(numberValue.intValue);
+      _builderPtr->addUInt(numberValue.mantissa);
     }
     return;
   }
 
-  double fractionalPart;
   if (i == '.') {
     // fraction. skip over '.'
     i = getOneOrThrow("Incomplete number");
@@ -174,56 +199,65 @@ void Parser::parseNumber() {
       throw Exception(Exception::ParseError, "Incomplete number");
     }
     unconsume();
-    fractionalPart = scanDigitsFractional();
-    if (negative) {
-      fractionalPart = -numberValue.asDouble() - fractionalPart;
-    } else {
-      fractionalPart = numberValue.asDouble() + fractionalPart;
-    }
+    scanDigitsFractional(numberValue);
     i = consume();
     if (i < 0) {
-      _builderPtr->addDouble(fractionalPart);
+      addDouble(numberValue, negative, startPos);
       return;
     }
-  } else {
-    if (negative) {
-      fractionalPart = -numberValue.asDouble();
-    } else {
-      fractionalPart = numberValue.asDouble();
-    }
   }
   if (i != 'e' && i != 'E') {
     unconsume();
-    // use conventional atof() conversion here, to avoid precision loss
-    // when interpreting and multiplying the single digits of the input stream
-    // _builderPtr->addDouble(fractionalPart);
-    _builderPtr->addDouble(atof(reinterpret_cast<char const*>(_start) + startPos));
+    addDouble(numberValue, negative, startPos);
     return;
   }
   i = getOneOrThrow("Incomplete number");
-  negative = false;
+  bool negativeExponent = false;
   if (i == '+' || i == '-') {
-    negative = (i == '-');
+    negativeExponent = (i == '-');
     i = getOneOrThrow("Incomplete number");
   }
   if (i < '0' || i > '9') {
     throw Exception(Exception::ParseError, "Incomplete number");
   }
   unconsume();
-  ParsedNumber exponent;
-  scanDigits(exponent);
-  if (negative) {
-    fractionalPart *= pow(10, -exponent.asDouble());
+  int64_t exponent = scanExponent();
+  if (negativeExponent) {
+    numberValue.exponent -= exponent;
   } else {
-    fractionalPart *= pow(10, exponent.asDouble());
+    numberValue.exponent += exponent;
   }
-  if (std::isnan(fractionalPart) || !std::isfinite(fractionalPart)) {
+  addDouble(numberValue, negative, startPos);
+}
+
+// converts the scanned digits into the nearest double value and adds it.
+// the text of the number is only looked at again in the rare cases in
+// which the fast conversion cannot decide on the correct rounding
+void Parser::addDouble(ParsedNumber const& numberValue, bool negative,
+                       std::size_t startPos) {
+  double value;
+  bool success;
+  if (!numberValue.truncated) {
+    success = decimalToDouble(numberValue.mantissa, numberValue.exponent, value);
+  } else {
+    // the exact value lies between mantissa and mantissa + 1. if both
+    // round to the same double, that is the result
+    double upper;
+    success = numberValue.mantissa != UINT64_MAX &&
+              decimalToDouble(numberValue.mantissa, numberValue.exponent, value) &&
+              decimalToDouble(numberValue.mantissa + 1, numberValue.exponent, upper) &&
+              value == upper;
+  }
+  if (VELOCYPACK_UNLIKELY(!success)) {
+    value = parseDoubleSlow(reinterpret_cast<char const*>(_start) + startPos,
+                            _pos - startPos);
+  } else if (negative) {
+    value = -value;
+  }
+  if (!std::isfinite(value)) {
     throw Exception(Exception::NumberOutOfRange);
   }
-  // use conventional atof() conversion here, to avoid precision loss
-  // when interpreting and multiplying the single digits of the input stream
-  // _builderPtr->addDouble(fractionalPart);
-  _builderPtr->addDouble(atof(reinterpret_cast<char const*>(_start) + startPos));
+  _builderPtr->addDouble(value);
 }
 
 void Parser::parseString() {
@@ -418,6 +452,79 @@ void Parser::parseString() {
   }
 }
 
+bool Parser::parseStringInSitu() {
+  ValueLength const minLength = options->inSituStringMinLength;
+  std::size_t const minHeaderSize = (minLength <= 126) ? 1 : 9;
+  if (_size - _pos < minLength + 1 || _pos - _inSituFree < minHeaderSize) {
+    // too short, or no room for a header in front of the string
+    return false;
+  }
+
+  // find the closing quote. give up on escape sequences and control
+  // characters. the SSE4.2 skip function may read up to 15 bytes over
+  // the given end, so only use it within the safe range
+  std::size_t const remainder = _size - _pos;
+  std::size_t len = 0;
+  if (remainder >= 16) {
+    len = JSONSkipString(_start + _pos, remainder - 15);
+  }
+  while (len < remainder && _start[_pos + len] >= 0x20 &&
+         _start[_pos + len] != '"' && _start[_pos + len] != '\\') {
+    ++len;
+  }
+  if (len == remainder || _start[_pos + len] != '"' || len < minLength) {
+    return false;
+  }
+  if (options->validateUtf8Strings && !ValidateUtf8String(_start + _pos, len)) {
+    // let the regular string parsing report the error
+    return false;
+  }
+
+  std::size_t const headerSize = (len <= 126) ? 1 : 9;
+  if (_pos - _inSituFree < headerSize) {
+    return false;
+  }
+  uint8_t* head = _inSitu + _pos - headerSize;
+  if (headerSize == 1) {
+    head[0] = 0x40 + static_cast<uint8_t>(len);
+  } else {
+    head[0] = 0xbf;
+    storeUInt64(head + 1, static_cast<uint64_t>(len));
+  }
+
+  _builderPtr->reserve(1 + sizeof(void*));
+  // store pointer. this doesn't need to be portable
+  _builderPtr->appendByteUnchecked(0x1d);
+  memcpy(_builderPtr->_start + _builderPtr->_pos, &head, sizeof(void*));
+  _builderPtr->advance(sizeof(void*));
+
+  _pos += len + 1;
+  _inSituFree = _pos;
+  return true;
+}
+
+void Parser::translateAttributeName(ValueLength keyPos) {
+  if (options->attributeTranslator != nullptr) {
+    // check if a translation for the attribute name exists
+    Slice key(_builderPtr->_start + keyPos);
+
+    if (key.isString()) {
+      ValueLength keyLength;
+      char const* p = key.getString(keyLength);
+      uint8_t const* translated =
+          options->attributeTranslator->translate(p, keyLength);
+
+      if (translated != nullptr) {
+        // found translation... now reset position to old key position
+        // and simply overwrite the existing key with the numeric translation
+        // id
+        _builderPtr->resetTo(keyPos);
+        _builderPtr->addUInt(Slice(translated).getUInt());
+      }
+    }
+  }
+}
+
 void Parser::parseArray() {
   _builderPtr->addArray();
 
@@ -482,26 +589,7 @@ void Parser::parseObject() {
     _builderPtr->reportAdd();
     auto const lastPos = _builderPtr->_pos;
     parseString();
-
-    if (options->attributeTranslator != nullptr) {
-      // check if a translation for the attribute name exists
-      Slice key(_builderPtr->_start + lastPos);
-
-      if (key.isString()) {
-        ValueLength keyLength;
-        char const* p = key.getString(keyLength);
-        uint8_t const* translated =
-            options->attributeTranslator->translate(p, keyLength);
-
-        if (translated != nullptr) {
-          // found translation... now reset position to old key position
-          // and simply overwrite the existing key with the numeric translation
-          // id
-          _builderPtr->resetTo(lastPos);
-          _builderPtr->addUInt(Slice(translated).getUInt());
-        }
-      }
-    }
+    translateAttributeName(lastPos);
 
     i = skipWhiteSpace("Expecting ':'");
     // always expecting the ':' here
@@ -559,7 +647,9 @@ void Parser::parseJson() {
       parseNull();  // this consumes "ull" or throws
       break;
     case '"':
-      parseString();
+      if (_inSitu == nullptr || !parseStringInSitu()) {
+        parseString();
+      }
       break;
     default: {
       // everything else must be a number or is invalid...
@@ -571,3 +661,633 @@ void Parser::parseJson() {
     }
   }
 }
+
+void Parser::parseProjected() {
+  int i = skipWhiteSpace("Expecting item");
+
+  _builderPtr->addObject();
+  if (i == '{') {
+    ++_pos;
+    parseObjectProjected(Projection::Root);
+  } else {
+    // only Objects can contain the selected paths
+    skipValue();
+  }
+  if (!options->keepTopLevelOpen) {
+    _builderPtr->close();
+  }
+}
+
+ValueLength Parser::parseObjectProjected(std::size_t node) {
+  Projection const& projection = *options->projection;
+  ValueLength added = 0;
+
+  int i = skipWhiteSpace("Expecting item or '}'");
+  if (i == '}') {
+    // empty object
+    ++_pos;
+    return added;
+  }
+
+  increaseNesting();
+
+  while (true) {
+    // always expecting a string attribute name here
+    if (VELOCYPACK_UNLIKELY(i != '"')) {
+      throw Exception(Exception::ParseError, "Expecting '\"' or '}'");
+    }
+    // get past the initial '"'
+    ++_pos;
+
+    std::size_t const keyStart = _pos;
+    std::size_t child;
+    if (!skipString()) {
+      child = projection.find(node, reinterpret_cast<char const*>(_start) + keyStart,
+                              _pos - 1 - keyStart);
+    } else {
+      // the attribute name contains escape sequences. unescape it
+      // temporarily at the end of the Builder to look it up
+      auto const lastPos = _builderPtr->_pos;
+      _pos = keyStart;
+      parseString();
+      ValueLength keyLength;
+      char const* p = Slice(_builderPtr->_start + lastPos).getString(keyLength);
+      child = projection.find(node, p, keyLength);
+      _builderPtr->resetTo(lastPos);
+    }
+
+    i = skipWhiteSpace("Expecting ':'");
+    // always expecting the ':' here
+    if (VELOCYPACK_UNLIKELY(i != ':')) {
+      throw Exception(Exception::ParseError, "Expecting ':'");
+    }
+    ++_pos;  // skip over the colon
+
+    if (child == Projection::NotFound) {
+      skipValue();
+    } else {
+      // build the attribute name, then return to the value
+      std::size_t const valuePos = _pos;
+      _pos = keyStart;
+      _builderPtr->reportAdd();
+      auto const lastPos = _builderPtr->_pos;
+      parseString();
+      translateAttributeName(lastPos);
+      _pos = valuePos;
+
+      if (projection.isComplete(child)) {
+        parseJson();
+        ++added;
+      } else if (skipWhiteSpace("Expecting item") == '{') {
+        ++_pos;
+        _builderPtr->addObject();
+        ValueLength const nested = parseObjectProjected(child);
+        _builderPtr->close();
+        if (nested > 0) {
+          ++added;
+        } else {
+          // nothing selected. remove the attribute again
+          _builderPtr->resetTo(lastPos);
+          _builderPtr->cleanupAdd();
+        }
+      } else {
+        // not an Object, so the path does not match
+        skipValue();
+        _builderPtr->resetTo(lastPos);
+        _builderPtr->cleanupAdd();
+      }
+    }
+
+    i = skipWhiteSpace("Expecting ',' or '}'");
+    if (i == '}') {
+      // end of object
+      ++_pos;  // the closing '}'
+      decreaseNesting();
+      return added;
+    }
+    if (VELOCYPACK_UNLIKELY(i != ',')) {
+      throw Exception(Exception::ParseError, "Expecting ',' or '}'");
+    }
+    // skip over ','
+    ++_pos;  // the ','
+    i = skipWhiteSpace("Expecting '\"' or '}'");
+  }
+}
+
+void Parser::skipValue() {
+  int i = skipWhiteSpace("Expecting item");
+  ++_pos;
+  switch (i) {
+    case '{':
+      skipObject();
+      break;
+    case '[':
+      skipArray();
+      break;
+    case 't':
+      if (consume() != 'r' || consume() != 'u' || consume() != 'e') {
+        throw Exception(Exception::ParseError, "Expecting 'true'");
+      }
+      break;
+    case 'f':
+      if (consume() != 'a' || consume() != 'l' || consume() != 's' ||
+          consume() != 'e') {
+        throw Exception(Exception::ParseError, "Expecting 'false'");
+      }
+      break;
+    case 'n':
+      if (consume() != 'u' || consume() != 'l' || consume() != 'l') {
+        throw Exception(Exception::ParseError, "Expecting 'null'");
+      }
+      break;
+    case '"':
+      skipString();
+      break;
+    default:
+      unconsume();
+      skipNumber();
+      break;
+  }
+}
+
+void Parser::skipObject() {
+  int i = skipWhiteSpace("Expecting item or '}'");
+  if (i == '}') {
+    ++_pos;
+    return;
+  }
+  while (true) {
+    if (VELOCYPACK_UNLIKELY(i != '"')) {
+      throw Exception(Exception::ParseError, "Expecting '\"' or '}'");
+    }
+    ++_pos;
+    skipString();
+    i = skipWhiteSpace("Expecting ':'");
+    if (VELOCYPACK_UNLIKELY(i != ':')) {
+      throw Exception(Exception::ParseError, "Expecting ':'");
+    }
+    ++_pos;
+    skipValue();
+    i = skipWhiteSpace("Expecting ',' or '}'");
+    if (i == '}') {
+      ++_pos;
+      return;
+    }
+    if (VELOCYPACK_UNLIKELY(i != ',')) {
+      throw Exception(Exception::ParseError, "Expecting ',' or '}'");
+    }
+    ++_pos;
+    i = skipWhiteSpace("Expecting '\"' or '}'");
+  }
+}
+
+void Parser::skipArray() {
+  int i = skipWhiteSpace("Expecting item or ']'");
+  if (i == ']') {
+    ++_pos;
+    return;
+  }
+  while (true) {
+    skipValue();
+    i = skipWhiteSpace("Expecting ',' or ']'");
+    if (i == ']') {
+      ++_pos;
+      return;
+    }
+    if (VELOCYPACK_UNLIKELY(i != ',')) {
+      throw Exception(Exception::ParseError, "Expecting ',' or ']'");
+    }
+    ++_pos;
+  }
+}
+
+bool Parser::skipString() {
+  std::size_t const start = _pos;
+  bool escapes = false;
+  while (true) {
+    std::size_t remainder = _size - _pos;
+    if (remainder >= 16) {
+      // the SSE4.2 accelerated function may peek up to 15 bytes over
+      // the given end
+      _pos += JSONSkipString(_start + _pos, remainder - 15);
+    }
+    int i = getOneOrThrow("Unfinished string");
+    if (i == '"') {
+      break;
+    }
+    if (i == '\\') {
+      escapes = true;
+      i = consume();
+      switch (i) {
+        case '"':
+        case '/':
+        case '\\':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+          break;
+        case 'u':
+          for (int j = 0; j < 4; j++) {
+            i = consume();
+            if (i < 0) {
+              throw Exception(Exception::ParseError,
+                              "Unfinished \\uXXXX escape sequence");
+            }
+            if (!((i >= '0' && i <= '9') || (i >= 'a' && i <= 'f') ||
+                  (i >= 'A' && i <= 'F'))) {
+              throw Exception(Exception::ParseError,
+                              "Illegal \\uXXXX escape sequence");
+            }
+          }
+          break;
+        default:
+          throw Exception(Exception::ParseError, "Invalid escape sequence");
+      }
+    } else if (VELOCYPACK_UNLIKELY(i < 0x20)) {
+      // control character
+      throw Exception(Exception::UnexpectedControlCharacter);
+    }
+  }
+  if (options->validateUtf8Strings &&
+      !ValidateUtf8String(_start + start, _pos - 1 - start)) {
+    throw Exception(Exception::InvalidUtf8Sequence);
+  }
+  return escapes;
+}
+
+void Parser::skipNumber() {
+  int i = consume();
+  if (i == '-') {
+    i = getOneOrThrow("Incomplete number");
+  }
+  if (i < '0' || i > '9') {
+    throw Exception(Exception::ParseError, "Expecting digit");
+  }
+  if (i != '0') {
+    skipDigits();
+  }
+  i = consume();
+  if (i == '.') {
+    i = getOneOrThrow("Incomplete number");
+    if (i < '0' || i > '9') {
+      throw Exception(Exception::ParseError, "Incomplete number");
+    }
+    skipDigits();
+    i = consume();
+  }
+  if (i == 'e' || i == 'E') {
+    i = getOneOrThrow("Incomplete number");
+    if (i == '+' || i == '-') {
+      i = getOneOrThrow("Incomplete number");
+    }
+    if (i < '0' || i > '9') {
+      throw Exception(Exception::ParseError, "Incomplete number");
+    }
+    skipDigits();
+  } else if (i >= 0) {
+    unconsume();
+  }
+}
+
+ValueLength Parser::parseInSitu(uint8_t* start, std::size_t size, bool multi) {
+  if (options->disallowExternals) {
+    throw Exception(Exception::BuilderExternalsDisallowed);
+  }
+  _inSitu = start;
+  _inSituFree = 0;
+  try {
+    ValueLength nr = parse(start, size, multi);
+    _inSitu = nullptr;
+    return nr;
+  } catch (...) {
+    _inSitu = nullptr;
+    throw;
+  }
+}
+
+void Parser::feed(uint8_t const* chunk, std::size_t size) {
+  bool const first = (_streamState == StreamState::Idle);
+  if (first) {
+    startStream();
+  }
+  _start = chunk;
+  _size = size;
+  _pos = 0;
+  if (first && _size >= 3 && _start[0] == 0xef && _start[1] == 0xbb &&
+      _start[2] == 0xbf) {
+    // found UTF-8 BOM. simply skip over it
+    _pos += 3;
+  }
+
+  try {
+    if (!_carry.empty() && !completeCarry()) {
+      return;
+    }
+    parseStream();
+  } catch (...) {
+    if (_streamReported) {
+      _builderPtr->cleanupAdd();
+    }
+    resetStream();
+    throw;
+  }
+}
+
+ValueLength Parser::finish() {
+  if (_streamState == StreamState::Idle) {
+    startStream();
+  }
+
+  try {
+    if (!_carry.empty()) {
+      // the end of the input terminates the pending token
+      _start = _carry.data();
+      _size = _carry.size();
+      _pos = 0;
+      parseCompleteToken();
+      parseStream();
+    }
+
+    switch (_streamState) {
+      case StreamState::Done:
+        break;
+      case StreamState::ValueOrEnd:
+        throw Exception(Exception::ParseError, "Expecting item or ']'");
+      case StreamState::KeyOrEnd:
+        throw Exception(Exception::ParseError, "Expecting item or '}'");
+      case StreamState::Key:
+        throw Exception(Exception::ParseError, "Expecting '\"' or '}'");
+      case StreamState::Colon:
+        throw Exception(Exception::ParseError, "Expecting ':'");
+      case StreamState::CommaOrEnd:
+        if (_streamStack.back() == '[') {
+          throw Exception(Exception::ParseError, "Expecting ',' or ']'");
+        }
+        throw Exception(Exception::ParseError, "Expecting ',' or '}'");
+      default:
+        throw Exception(Exception::ParseError, "Expecting item");
+    }
+  } catch (...) {
+    if (_streamReported) {
+      _builderPtr->cleanupAdd();
+    }
+    resetStream();
+    throw;
+  }
+
+  resetStream();
+  return 1;
+}
+
+void Parser::startStream() {
+  if (options->projection != nullptr) {
+    throw Exception(Exception::NotImplemented,
+                    "projections are not supported when parsing incrementally");
+  }
+  if (options->clearBuilderBeforeParse) {
+    _builder->clear();
+  }
+  resetStream();
+  _streamState = StreamState::Value;
+}
+
+void Parser::resetStream() {
+  _streamState = StreamState::Idle;
+  _streamStack.clear();
+  _carry.clear();
+  _carryEscaped = false;
+  _streamReported = false;
+}
+
+void Parser::parseStream() {
+  while (true) {
+    while (_pos < _size && isWhiteSpace(_start[_pos])) {
+      ++_pos;
+    }
+    if (_pos >= _size) {
+      return;
+    }
+
+    uint8_t const c = _start[_pos];
+    switch (_streamState) {
+      case StreamState::ValueOrEnd:
+        if (c == ']') {
+          // empty array
+          closeStreamCompound();
+          break;
+        }
+        // fall-through
+      case StreamState::Value:
+        if (_streamStack.empty()) {
+          _streamReported = prepareTopLevelValue();
+        } else if (_streamStack.back() == '[') {
+          _builderPtr->reportAdd();
+        }
+        if (c == '{') {
+          ++_pos;
+          _builderPtr->addObject();
+          _streamStack.push_back('{');
+          _streamState = StreamState::KeyOrEnd;
+        } else if (c == '[') {
+          ++_pos;
+          _builderPtr->addArray();
+          _streamStack.push_back('[');
+          _streamState = StreamState::ValueOrEnd;
+        } else if (!parseStreamToken()) {
+          return;
+        }
+        break;
+
+      case StreamState::KeyOrEnd:
+        if (c == '}') {
+          // empty object
+          closeStreamCompound();
+          break;
+        }
+        // fall-through
+      case StreamState::Key:
+        // always expecting a string attribute name here
+        if (VELOCYPACK_UNLIKELY(c != '"')) {
+          throw Exception(Exception::ParseError, "Expecting '\"' or '}'");
+        }
+        _builderPtr->reportAdd();
+        _streamKeyPos = _builderPtr->_pos;
+        if (!parseStreamToken()) {
+          return;
+        }
+        break;
+
+      case StreamState::Colon:
+        if (VELOCYPACK_UNLIKELY(c != ':')) {
+          throw Exception(Exception::ParseError, "Expecting ':'");
+        }
+        ++_pos;
+        _streamState = StreamState::Value;
+        break;
+
+      case StreamState::CommaOrEnd:
+        if (_streamStack.back() == '[') {
+          if (c == ']') {
+            closeStreamCompound();
+          } else if (VELOCYPACK_LIKELY(c == ',')) {
+            ++_pos;
+            _streamState = StreamState::Value;
+          } else {
+            throw Exception(Exception::ParseError, "Expecting ',' or ']'");
+          }
+        } else {
+          if (c == '}') {
+            closeStreamCompound();
+          } else if (VELOCYPACK_LIKELY(c == ',')) {
+            ++_pos;
+            _streamState = StreamState::Key;
+          } else {
+            throw Exception(Exception::ParseError, "Expecting ',' or '}'");
+          }
+        }
+        break;
+
+      default:
+        VELOCYPACK_ASSERT(_streamState == StreamState::Done);
+        consume();  // to get error reporting right. return value intentionally not checked
+        throw Exception(Exception::ParseError, "Expecting EOF");
+    }
+  }
+}
+
+bool Parser::parseStreamToken() {
+  std::size_t const tokenStart = _pos;
+  std::size_t used;
+  _carryEscaped = false;
+  if (!findTokenEnd(_start[tokenStart], _start + tokenStart + 1,
+                    _size - tokenStart - 1, 1, used)) {
+    // cut off by the end of the chunk. keep the start of the token
+    // until the next chunk arrives
+    _carry.append(_start + tokenStart, _size - tokenStart);
+    _pos = _size;
+    return false;
+  }
+  parseCompleteToken();
+  return true;
+}
+
+bool Parser::completeCarry() {
+  std::size_t used;
+  if (!findTokenEnd(_carry.data()[0], _start, _size, _carry.size(), used)) {
+    _carry.append(_start, _size);
+    _pos = _size;
+    return false;
+  }
+  _carry.append(_start, used);
+
+  uint8_t const* chunk = _start;
+  std::size_t const chunkSize = _size;
+  _start = _carry.data();
+  _size = _carry.size();
+  _pos = 0;
+  parseCompleteToken();
+  // anything in _carry that does not belong to the token is an error,
+  // which parseStream() will report
+  parseStream();
+
+  _carry.reset();
+  _start = chunk;
+  _size = chunkSize;
+  _pos = used;
+  return true;
+}
+
+void Parser::parseCompleteToken() {
+  int i = consume();
+  switch (i) {
+    case 't':
+      parseTrue();  // this consumes "rue" or throws
+      break;
+    case 'f':
+      parseFalse();  // this consumes "alse" or throws
+      break;
+    case 'n':
+      parseNull();  // this consumes "ull" or throws
+      break;
+    case '"':
+      parseString();
+      break;
+    default:
+      unconsume();
+      parseNumber();  // this consumes the number or throws
+      break;
+  }
+  afterStreamToken();
+}
+
+void Parser::afterStreamToken() {
+  if (_streamState == StreamState::KeyOrEnd ||
+      _streamState == StreamState::Key) {
+    translateAttributeName(_streamKeyPos);
+    _streamState = StreamState::Colon;
+  } else {
+    afterStreamValue();
+  }
+}
+
+void Parser::afterStreamValue() {
+  if (_streamStack.empty()) {
+    _streamState = StreamState::Done;
+    _streamReported = false;
+  } else {
+    _streamState = StreamState::CommaOrEnd;
+  }
+}
+
+void Parser::closeStreamCompound() {
+  ++_pos;  // the closing ']' or '}'
+  if (_streamStack.back() == '[' || _streamStack.size() != 1 ||
+      !options->keepTopLevelOpen) {
+    // only close if we've not been asked to keep top level open
+    _builderPtr->close();
+  }
+  _streamStack.pop_back();
+  afterStreamValue();
+}
+
+bool Parser::findTokenEnd(uint8_t first, uint8_t const* p, std::size_t len,
+                          std::size_t have, std::size_t& used) {
+  if (first == '"') {
+    std::size_t offset = 0;
+    while (true) {
+      void const* q = memchr(p + offset, '"', len - offset);
+      if (q == nullptr) {
+        _carryEscaped = isEscaped(p, len, _carryEscaped);
+        used = len;
+        return false;
+      }
+      std::size_t const quote = static_cast<uint8_t const*>(q) - p;
+      if (!isEscaped(p, quote, _carryEscaped)) {
+        _carryEscaped = false;
+        used = quote + 1;
+        return true;
+      }
+      offset = quote + 1;
+    }
+  }
+  if (first == 't' || first == 'n' || first == 'f') {
+    std::size_t const need = (first == 'f' ? 5 : 4) - have;
+    used = (std::min)(need, len);
+    return len >= need;
+  }
+  used = 0;
+  if (first != '-' && (first < '0' || first > '9')) {
+    // an invalid token, which parseNumber() will report
+    return true;
+  }
+  for (; used < len; ++used) {
+    uint8_t const c = p[used];
+    if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' &&
+        c != 'e' && c != 'E') {
+      return true;
+    }
+  }
+  return false;
+}
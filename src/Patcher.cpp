@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AttributeTranslator.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Patcher.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// an Object on the path to the replaced value
+struct Level {
+  ValueLength container;  // offset of the Object
+  ValueLength value;      // offset of its member on the path
+};
+
+// byte width of the index table entries of an indexed Object, or 0 for
+// a compact Object
+inline ValueLength offsetSize(uint8_t head) noexcept {
+  if (head >= 0x0b && head <= 0x12) {
+    return ValueLength(1) << ((head - 0x0b) & 0x03);
+  }
+  VELOCYPACK_ASSERT(head == 0x14);
+  return 0;
+}
+
+inline void storeInteger(uint8_t* dst, ValueLength value,
+                         ValueLength length) noexcept {
+  for (ValueLength i = 0; i < length; ++i) {
+    dst[i] = static_cast<uint8_t>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+// collects the Objects on the path. returns false if the path does not
+// exist
+template <typename T>
+bool findPath(uint8_t const* start, std::vector<T> const& path,
+              std::vector<Level>& levels) {
+  if (path.empty()) {
+    throw Exception(Exception::InvalidAttributePath);
+  }
+  Slice current(start);
+  if (!current.isObject()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Object");
+  }
+  levels.reserve(path.size());
+  for (std::size_t i = 0; i < path.size(); ++i) {
+    Slice value = current.get(path[i]);
+    if (value.isNone()) {
+      return false;
+    }
+    levels.push_back(Level{static_cast<ValueLength>(current.start() - start),
+                           static_cast<ValueLength>(value.start() - start)});
+    if (i + 1 < path.size()) {
+      if (!value.isObject()) {
+        return false;
+      }
+      current = value;
+    }
+  }
+  return true;
+}
+
+// whether the header of the Object at start can take a change of its
+// byte size by delta
+bool canAdjust(uint8_t const* start, int64_t delta) {
+  ValueLength const width = offsetSize(*start);
+  if (width == 0) {
+    // the byte length of a compact Object must keep its own length
+    ValueLength const byteSize = readVariableValueLength<false>(start + 1);
+    return getVariableValueLength(byteSize) ==
+           getVariableValueLength(byteSize + delta);
+  }
+  if (width == 8) {
+    return true;
+  }
+  ValueLength const byteSize = readIntegerNonEmpty<ValueLength>(start + 1, width);
+  return byteSize + delta < (ValueLength(1) << (8 * width));
+}
+
+// adjusts the header and index table of the Object at start after its
+// member at offset value has changed its byte size by delta. the index
+// table is expected at its new position already
+void adjust(uint8_t* start, ValueLength value, int64_t delta) {
+  ValueLength const width = offsetSize(*start);
+  if (width == 0) {
+    ValueLength const byteSize = readVariableValueLength<false>(start + 1);
+    storeVariableValueLength<false>(start + 1, byteSize + delta);
+    return;
+  }
+
+  ValueLength const byteSize =
+      readIntegerNonEmpty<ValueLength>(start + 1, width) + delta;
+  storeInteger(start + 1, byteSize, width);
+
+  ValueLength n;
+  ValueLength end = byteSize;
+  if (width < 8) {
+    n = readIntegerNonEmpty<ValueLength>(start + 1 + width, width);
+  } else {
+    end -= 8;
+    n = readIntegerNonEmpty<ValueLength>(start + end, 8);
+  }
+  // only the members behind the changed one have moved
+  uint8_t* table = start + end - n * width;
+  for (ValueLength i = 0; i < n; ++i) {
+    ValueLength const offset = readIntegerNonEmpty<ValueLength>(table, width);
+    if (offset > value) {
+      storeInteger(table, offset + delta, width);
+    }
+    table += width;
+  }
+}
+
+// replaces size bytes at position with the contents of data
+void splice(Buffer<uint8_t>& buffer, ValueLength position, ValueLength size,
+            Buffer<uint8_t> const& data) {
+  ValueLength const tail = buffer.size() - position - size;
+  if (data.size() > size) {
+    buffer.reserve(data.size() - size);
+    buffer.advance(checkOverflow(data.size() - size));
+  }
+  uint8_t* p = buffer.data() + position;
+  memmove(p + data.size(), p + size, checkOverflow(tail));
+  memcpy(p, data.data(), checkOverflow(data.size()));
+  if (data.size() < size) {
+    buffer.rollback(checkOverflow(size - data.size()));
+  }
+}
+
+// splices data into the member of levels[last] and adjusts the Objects
+// levels[first] to levels[last]. all offsets are relative to base
+void spliceAndAdjust(Buffer<uint8_t>& buffer, std::vector<Level> const& levels,
+                     std::size_t first, std::size_t last, ValueLength base,
+                     Buffer<uint8_t> const& data) {
+  ValueLength const value = levels[last].value - base;
+  ValueLength const size = Slice(buffer.data() + value).byteSize();
+  int64_t const delta = static_cast<int64_t>(data.size()) - static_cast<int64_t>(size);
+  splice(buffer, value, size, data);
+  for (std::size_t i = last + 1; i-- > first; ) {
+    ValueLength const container = levels[i].container - base;
+    adjust(buffer.data() + container, levels[i].value - base - container, delta);
+  }
+}
+
+// the attribute name of a key. integer keys are translated with the
+// attribute translator of options, so that the Builder turns them into
+// the same integer keys again, or with the default one
+StringRef keyName(Slice key, Options const* options) {
+  if (key.isString()) {
+    return key.stringRef();
+  }
+  AttributeTranslator const* translator = options->attributeTranslator;
+  if (translator == nullptr) {
+    translator = Options::Defaults.attributeTranslator;
+  }
+  if (VELOCYPACK_UNLIKELY(translator == nullptr)) {
+    throw Exception(Exception::NeedAttributeTranslator);
+  }
+  uint8_t const* name = translator->translate(key.getUInt());
+  if (VELOCYPACK_UNLIKELY(name == nullptr)) {
+    throw Exception(Exception::InvalidValueType, "Cannot translate key");
+  }
+  return Slice(name).stringRef();
+}
+
+// builds the Object at start again, with the member at value replaced
+Builder rebuild(uint8_t const* start, uint8_t const* value,
+                Buffer<uint8_t> const& data, Options const* options) {
+  Slice object(start);
+  Builder b(options);
+  b.openObject(object.head() == 0x14);
+  ObjectIterator it(object, true);
+  while (it.valid()) {
+    StringRef const name = keyName(it.key(false), options);
+    Slice const current = it.value();
+    if (current.start() == value) {
+      b.add(name, Slice(data.data()));
+    } else {
+      b.add(name, current);
+    }
+    it.next();
+  }
+  b.close();
+  return b;
+}
+
+template <typename T>
+bool replaceValue(Buffer<uint8_t>& buffer, std::vector<T> const& path,
+                  Slice value, Options const* options) {
+  std::vector<Level> levels;
+  if (!findPath(buffer.data(), path, levels)) {
+    return false;
+  }
+
+  uint8_t* target = buffer.data() + levels.back().value;
+  ValueLength const size = value.byteSize();
+  if (Slice(target).byteSize() == size) {
+    memmove(target, value.start(), checkOverflow(size));
+    return true;
+  }
+
+  // the value may point into the buffer, which can be reallocated
+  Buffer<uint8_t> data;
+  data.append(value.start(), size);
+
+  // the innermost Object whose member on the path changes
+  std::size_t last = levels.size() - 1;
+  while (true) {
+    ValueLength const old = Slice(buffer.data() + levels[last].value).byteSize();
+    int64_t const delta = static_cast<int64_t>(data.size()) - static_cast<int64_t>(old);
+    if (delta == 0) {
+      memcpy(buffer.data() + levels[last].value, data.data(), checkOverflow(old));
+      return true;
+    }
+
+    // find the innermost Object that cannot be adjusted in place
+    std::size_t i = last + 1;
+    while (i > 0 && canAdjust(buffer.data() + levels[i - 1].container, delta)) {
+      --i;
+    }
+    if (i == 0) {
+      spliceAndAdjust(buffer, levels, 0, last, 0, data);
+      return true;
+    }
+    std::size_t const rebuilt = i - 1;
+
+    if (rebuilt < last) {
+      // the member of the rebuilt Object is adjusted in a copy
+      ValueLength const base = levels[rebuilt + 1].container;
+      Buffer<uint8_t> member;
+      member.append(buffer.data() + base,
+                    Slice(buffer.data() + base).byteSize());
+      spliceAndAdjust(member, levels, rebuilt + 1, last, base, data);
+      data = std::move(member);
+    }
+
+    Builder b = rebuild(buffer.data() + levels[rebuilt].container,
+                        buffer.data() + levels[rebuilt].value, data, options);
+    data.clear();
+    data.append(b.start(), b.size());
+
+    if (rebuilt == 0) {
+      // the outermost Object itself was rebuilt
+      splice(buffer, 0, Slice(buffer.data()).byteSize(), data);
+      return true;
+    }
+    last = rebuilt - 1;
+  }
+}
+
+template <typename T>
+bool replaceValueInPlace(uint8_t* start, std::vector<T> const& path,
+                         Slice value) {
+  std::vector<Level> levels;
+  if (!findPath(start, path, levels)) {
+    return false;
+  }
+  uint8_t* target = start + levels.back().value;
+  ValueLength const size = value.byteSize();
+  if (Slice(target).byteSize() != size) {
+    return false;
+  }
+  memmove(target, value.start(), checkOverflow(size));
+  return true;
+}
+
+} // namespace
+
+bool Patcher::replace(Buffer<uint8_t>& buffer,
+                      std::vector<std::string> const& path, Slice value,
+                      Options const* options) {
+  return ::replaceValue(buffer, path, value, options);
+}
+
+template <typename T>
+bool Patcher::replace(Buffer<uint8_t>& buffer, std::vector<T> const& path,
+                      Slice value, Options const* options) {
+  return ::replaceValue(buffer, path, value, options);
+}
+
+bool Patcher::replaceInPlace(uint8_t* start,
+                             std::vector<std::string> const& path,
+                             Slice value) {
+  return ::replaceValueInPlace(start, path, value);
+}
+
+template <typename T>
+bool Patcher::replaceInPlace(uint8_t* start, std::vector<T> const& path,
+                             Slice value) {
+  return ::replaceValueInPlace(start, path, value);
+}
+
+template bool Patcher::replace<StringRef>(Buffer<uint8_t>&,
+                                          std::vector<StringRef> const&,
+                                          Slice, Options const*);
+template bool Patcher::replaceInPlace<StringRef>(uint8_t*,
+                                                 std::vector<StringRef> const&,
+                                                 Slice);
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Projection.h"
+
+using namespace arangodb::velocypack;
+
+constexpr std::size_t Projection::Root;
+constexpr std::size_t Projection::NotFound;
+
+Projection::Projection() { _nodes.emplace_back(std::string()); }
+
+Projection::Projection(std::initializer_list<std::string> paths)
+    : Projection() {
+  for (auto const& path : paths) {
+    add(path);
+  }
+}
+
+Projection::Projection(std::vector<std::string> const& paths) : Projection() {
+  for (auto const& path : paths) {
+    add(path);
+  }
+}
+
+void Projection::add(std::string const& path) {
+  std::vector<std::string> parts;
+  std::size_t start = 0;
+  while (true) {
+    std::size_t end = path.find('.', start);
+    if (end == std::string::npos) {
+      parts.emplace_back(path.substr(start));
+      break;
+    }
+    parts.emplace_back(path.substr(start, end - start));
+    start = end + 1;
+  }
+  add(parts);
+}
+
+void Projection::add(std::vector<std::string> const& path) {
+  if (path.empty()) {
+    throw Exception(Exception::InvalidAttributePath);
+  }
+  std::size_t current = Root;
+  for (auto const& name : path) {
+    if (_nodes[current].complete) {
+      // a prefix of the path is selected already
+      return;
+    }
+    std::size_t child = find(current, name.data(), name.size());
+    if (child == NotFound) {
+      child = _nodes.size();
+      _nodes.emplace_back(name);
+      _nodes[current].children.push_back(child);
+    }
+    current = child;
+  }
+  _nodes[current].complete = true;
+}
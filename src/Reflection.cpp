@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Reflection.h"
+
+using namespace arangodb::velocypack;
+
+constexpr std::size_t ReflectIndex::notFound;
+
+ReflectIndex::ReflectIndex(StringRef const* names, std::size_t n)
+    : _names(names), _n(n), _seed(0), _mask(0) {
+  if (VELOCYPACK_UNLIKELY(n > 255)) {
+    throw Exception(Exception::NumberOutOfRange, "Too many fields");
+  }
+  // start with a table that is at most half full, and make it larger
+  // if no seed gives a perfect hash
+  uint64_t size = 1;
+  while (size < 2 * n) {
+    size <<= 1;
+  }
+  while (true) {
+    for (uint64_t seed = 0; seed < 64; ++seed) {
+      if (tryBuild(seed, size - 1)) {
+        return;
+      }
+    }
+    size <<= 1;
+    if (VELOCYPACK_UNLIKELY(size > (uint64_t(1) << 16))) {
+      // only equal names keep colliding
+      throw Exception(Exception::InternalError, "Duplicate field names");
+    }
+  }
+}
+
+bool ReflectIndex::tryBuild(uint64_t seed, uint64_t mask) {
+  _slots.assign(checkOverflow(mask + 1), 0);
+  for (std::size_t i = 0; i < _n; ++i) {
+    uint8_t& slot = _slots[hash(_names[i].data(), _names[i].size(), seed) & mask];
+    if (slot != 0) {
+      return false;
+    }
+    slot = static_cast<uint8_t>(i + 1);
+  }
+  _seed = seed;
+  _mask = mask;
+  return true;
+}
@@ -22,6 +22,7 @@
 /// @author Jan Steemann
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <ostream>
 
 #include "velocypack/velocypack-common.h"
@@ -43,6 +44,29 @@ int64_t const maxValues[] = {
   128, 32768, 8388608, 2147483648, 549755813888, 140737488355328, 36028797018963968
 };
 
+// only use binary search for attributes if we have at least this many entries
+// otherwise we'll always use the linear search. tools/bench-lookup shows
+// both searches on par at this size for all index entry widths
+constexpr ValueLength SortedSearchEntriesThreshold = 4;
+
+// from this many entries on, the index table and keys of large Objects
+// are unlikely to be in the cache, and the binary search prefetches the
+// keys of its next step instead of branching on every comparison
+constexpr ValueLength PrefetchSearchEntriesThreshold = 1024;
+
+// head byte of a String with the given length, as written by the Builder
+inline uint8_t stringHead(std::size_t length) noexcept {
+  return (length <= 126) ? static_cast<uint8_t>(0x40 + length) : 0xbf;
+}
+
+// whether a key with this head byte can be equal to a String with the
+// head byte wanted. short Strings of another length are ruled out without
+// decoding them. long Strings and integer keys need a closer look.
+// Externals are never valid keys
+inline bool mayBeEqual(uint8_t head, uint8_t wanted) noexcept {
+  return head == wanted || (head < 0x40 && head != 0x1d) || head >= 0xbf;
+}
+
 } // namespace
   
 uint8_t const Slice::noneSliceData[] = { 0x00 };
@@ -132,8 +156,10 @@ std::string Slice::toJson(Options const* options) const {
 }
 
 std::string Slice::toString(Options const* options) const {
-  if (isString()) {
-    return copyString();
+  // in-situ strings are Externals pointing to the String
+  Slice const value = resolveExternals();
+  if (value.isString()) {
+    return value.copyString();
   }
 
   // copy options and set prettyPrint in copy
@@ -151,6 +177,11 @@ std::string Slice::hexType() const { return HexDump::toHex(head()); }
 uint64_t Slice::normalizedHash(uint64_t seed) const {
   uint64_t value;
 
+  if (head() == 0x1d) {
+    // hash the value the External points to
+    return resolveExternals().normalizedHash(seed);
+  }
+
   if (isNumber()) {
     // upcast integer values to double
     double v = getNumericValue<double>();
@@ -190,6 +221,11 @@ uint64_t Slice::normalizedHash(uint64_t seed) const {
 uint32_t Slice::normalizedHash32(uint32_t seed) const {
   uint32_t value;
 
+  if (head() == 0x1d) {
+    // hash the value the External points to
+    return resolveExternals().normalizedHash32(seed);
+  }
+
   if (isNumber()) {
     // upcast integer values to double
     double v = getNumericValue<double>();
@@ -282,10 +318,6 @@ Slice Slice::get(StringRef const& attribute) const {
     return Slice();
   }
 
-  // only use binary search for attributes if we have at least this many entries
-  // otherwise we'll always use the linear search
-  constexpr ValueLength SortedSearchEntriesThreshold = 4;
-
   if (n >= SortedSearchEntriesThreshold && (h >= 0x0b && h <= 0x0e)) {
     switch (offsetSize) {
       case 1:
@@ -303,6 +335,58 @@ Slice Slice::get(StringRef const& attribute) const {
   return searchObjectKeyLinear(attribute, ieBase, offsetSize, n);
 }
 
+// look for multiple sorted attributes inside an Object
+ValueLength Slice::get(StringRef const* attributes, std::size_t n,
+                       Slice* values) const {
+  if (VELOCYPACK_UNLIKELY(!isObject())) {
+    throw Exception(Exception::InvalidValueType, "Expecting Object");
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    if (VELOCYPACK_UNLIKELY(i > 0 && attributes[i - 1].compare(attributes[i]) > 0)) {
+      throw Exception(Exception::InvalidAttributePath, "Expecting sorted attributes");
+    }
+    values[i] = Slice();
+  }
+
+  auto const h = head();
+  if (n == 0 || h == 0x0a) {
+    // nothing to look for, or empty object
+    return 0;
+  }
+
+  if (h >= 0x0b && h <= 0x0e) {
+    ValueLength const offsetSize = indexEntrySize(h);
+    ValueLength const end = readIntegerNonEmpty<ValueLength>(start() + 1, offsetSize);
+
+    ValueLength entries;
+    ValueLength ieBase;
+    if (offsetSize < 8) {
+      entries = readIntegerNonEmpty<ValueLength>(start() + 1 + offsetSize, offsetSize);
+      ieBase = end - entries * offsetSize;
+    } else {
+      entries = readIntegerNonEmpty<ValueLength>(start() + end - offsetSize, offsetSize);
+      ieBase = end - entries * offsetSize - offsetSize;
+    }
+
+    if (entries >= SortedSearchEntriesThreshold) {
+      switch (offsetSize) {
+        case 1:
+          return searchObjectKeysBinary<1>(attributes, n, values, ieBase, entries);
+        case 2:
+          return searchObjectKeysBinary<2>(attributes, n, values, ieBase, entries);
+        case 4:
+          return searchObjectKeysBinary<4>(attributes, n, values, ieBase, entries);
+        case 8:
+          return searchObjectKeysBinary<8>(attributes, n, values, ieBase, entries);
+        default: {}
+      }
+    }
+  }
+
+  return searchObjectKeysLinear(attributes, n, values);
+}
+
 // return the value for an Int object
 int64_t Slice::getIntUnchecked() const noexcept {
   uint8_t const h = head();
@@ -459,10 +543,12 @@ bool Slice::isEqualStringUnchecked(StringRef const& attribute) const noexcept {
 }
 
 Slice Slice::getFromCompactObject(StringRef const& attribute) const {
+  uint8_t const wanted = stringHead(attribute.size());
+
   ObjectIterator it(*this);
   while (it.valid()) {
     Slice key = it.key(false);
-    if (key.makeKey().isEqualString(attribute)) {
+    if (mayBeEqual(key.head(), wanted) && key.makeKey().isEqualString(attribute)) {
       return Slice(key.start() + key.byteSize());
     }
 
@@ -596,12 +682,24 @@ Slice Slice::searchObjectKeyLinear(StringRef const& attribute,
                                    ValueLength ieBase, ValueLength offsetSize,
                                    ValueLength n) const {
   bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
+  std::size_t const length = attribute.size();
+  uint8_t const wanted = stringHead(length);
 
   for (ValueLength index = 0; index < n; ++index) {
     ValueLength offset = ieBase + index * offsetSize;
     Slice key(start() + readIntegerNonEmpty<ValueLength>(start() + offset, offsetSize));
 
-    if (key.isString()) {
+    uint8_t const h = key.head();
+    if (!mayBeEqual(h, wanted)) {
+      // a short String of another length
+      continue;
+    }
+    if (h == wanted && h != 0xbf) {
+      // a short String of the same length, compare its characters only
+      if (memcmp(key.start() + 1, attribute.data(), length) != 0) {
+        continue;
+      }
+    } else if (key.isString()) {
       if (!key.isEqualStringUnchecked(attribute)) {
         continue;
       } 
@@ -627,11 +725,134 @@ Slice Slice::searchObjectKeyLinear(StringRef const& attribute,
   return Slice();
 }
 
+// look up every member key of an Object among the sorted attributes
+ValueLength Slice::searchObjectKeysLinear(StringRef const* attributes,
+                                          std::size_t n, Slice* values) const {
+  StringRef const* end = attributes + n;
+  ValueLength found = 0;
+
+  ObjectIterator it(*this, true);
+  while (it.valid()) {
+    Slice key = it.key(false);
+    StringRef const name = key.makeKey().stringRef();
+
+    StringRef const* match = std::lower_bound(attributes, end, name,
+        [](StringRef const& lhs, StringRef const& rhs) {
+          return lhs.compare(rhs) < 0;
+        });
+    // the first occurrence of a duplicate key wins, as in get()
+    while (match != end && match->equals(name)) {
+      Slice& value = values[match - attributes];
+      if (value.isNone()) {
+        value = Slice(key.start() + key.byteSize());
+        ++found;
+      }
+      ++match;
+    }
+    if (found == n) {
+      break;
+    }
+
+    it.next();
+  }
+
+  return found;
+}
+
+// perform a merge of the sorted attributes with the sorted index table of
+// an Object. each attribute gallops forward from the position of its
+// predecessor, so the whole lookup never goes back in the index table
+template<ValueLength offsetSize>
+ValueLength Slice::searchObjectKeysBinary(StringRef const* attributes,
+                                          std::size_t n, Slice* values,
+                                          ValueLength ieBase,
+                                          ValueLength entries) const {
+  bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
+  VELOCYPACK_ASSERT(entries > 0);
+
+  auto keyAt = [this, ieBase](ValueLength index) -> Slice {
+    ValueLength offset = ieBase + index * offsetSize;
+    return Slice(start() + readIntegerFixed<ValueLength, offsetSize>(start() + offset));
+  };
+  auto compare = [useTranslator](Slice key, StringRef const& attribute) -> int {
+    if (key.isString()) {
+      return key.compareStringUnchecked(attribute.data(), attribute.size());
+    }
+    VELOCYPACK_ASSERT(key.isSmallInt() || key.isUInt());
+    // translate key
+    if (VELOCYPACK_UNLIKELY(!useTranslator)) {
+      // no attribute translator
+      throw Exception(Exception::NeedAttributeTranslator);
+    }
+    return key.translateUnchecked().compareString(attribute);
+  };
+
+  ValueLength found = 0;
+  // all index entries below l are less than the current attribute
+  ValueLength l = 0;
+
+  for (std::size_t i = 0; i < n && l < entries; ++i) {
+    if (i > 0 && attributes[i].equals(attributes[i - 1])) {
+      values[i] = values[i - 1];
+      found += values[i].isNone() ? 0 : 1;
+      continue;
+    }
+
+    // gallop until an entry is not less than the attribute
+    ValueLength r = l;
+    ValueLength step = 1;
+    int res = -1;
+    while (r < entries) {
+      res = compare(keyAt(r), attributes[i]);
+      if (res >= 0) {
+        break;
+      }
+      l = r + 1;
+      r += step;
+      step *= 2;
+    }
+
+    if (res != 0) {
+      // binary search between the last two gallop positions
+      r = (std::min)(r, entries);
+      while (l < r) {
+        ValueLength index = l + ((r - l) / 2);
+        res = compare(keyAt(index), attributes[i]);
+        if (res > 0) {
+          r = index;
+        } else if (res == 0) {
+          l = index;
+          break;
+        } else {
+          l = index + 1;
+        }
+      }
+      if (res != 0) {
+        // not found
+        continue;
+      }
+    } else {
+      l = r;
+    }
+
+    Slice key = keyAt(l);
+    values[i] = Slice(key.start() + key.byteSize());
+    ++found;
+    ++l;
+  }
+
+  return found;
+}
+
 // perform a binary search for the specified attribute inside an Object
 template<ValueLength offsetSize>
 Slice Slice::searchObjectKeyBinary(StringRef const& attribute,
                                    ValueLength ieBase,
                                    ValueLength n) const {
+  if (n >= PrefetchSearchEntriesThreshold) {
+    return searchObjectKeyPrefetch<offsetSize>(attribute, ieBase, n);
+  }
+
   bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
   VELOCYPACK_ASSERT(n > 0);
 
@@ -673,12 +894,77 @@ Slice Slice::searchObjectKeyBinary(StringRef const& attribute,
   return Slice();
 }
 
+// perform a binary search for the specified attribute inside a large
+// Object. the search narrows down to a single candidate without branching
+// on the comparison results, and prefetches both keys that the next step
+// may compare, so that the index table and key lookups of consecutive
+// steps overlap instead of stalling one after the other
+template<ValueLength offsetSize>
+Slice Slice::searchObjectKeyPrefetch(StringRef const& attribute,
+                                     ValueLength ieBase,
+                                     ValueLength n) const {
+  bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
+  VELOCYPACK_ASSERT(n > 0);
+
+  uint8_t const* table = start() + ieBase;
+  auto keyAt = [this, table](ValueLength index) -> uint8_t const* {
+    return start() + readIntegerFixed<ValueLength, offsetSize>(table + index * offsetSize);
+  };
+  auto compare = [useTranslator, &attribute](Slice key) -> int {
+    if (key.isString()) {
+      return key.compareStringUnchecked(attribute.data(), attribute.size());
+    }
+    VELOCYPACK_ASSERT(key.isSmallInt() || key.isUInt());
+    // translate key
+    if (VELOCYPACK_UNLIKELY(!useTranslator)) {
+      // no attribute translator
+      throw Exception(Exception::NeedAttributeTranslator);
+    }
+    return key.translateUnchecked().compareString(attribute);
+  };
+
+  // the attribute can only be in the range [base, base + length)
+  ValueLength base = 0;
+  ValueLength length = n;
+  while (length > 1) {
+    ValueLength const half = length / 2;
+    ValueLength const next = (length - half) / 2;
+    VELOCYPACK_PREFETCH(keyAt(base + next));
+    VELOCYPACK_PREFETCH(keyAt(base + half + next));
+
+    int res = compare(Slice(keyAt(base + half)));
+    base = (res <= 0) ? base + half : base;
+    length -= half;
+  }
+
+  Slice key(keyAt(base));
+  if (compare(key) == 0) {
+    // found. now return a Slice pointing at the value
+    return Slice(key.start() + key.byteSize());
+  }
+
+  // not found
+  return Slice();
+}
+
 // template instanciations for searchObjectKeyBinary
 template Slice Slice::searchObjectKeyBinary<1>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
 template Slice Slice::searchObjectKeyBinary<2>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
 template Slice Slice::searchObjectKeyBinary<4>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
 template Slice Slice::searchObjectKeyBinary<8>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
 
+// template instanciations for searchObjectKeyPrefetch
+template Slice Slice::searchObjectKeyPrefetch<1>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
+template Slice Slice::searchObjectKeyPrefetch<2>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
+template Slice Slice::searchObjectKeyPrefetch<4>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
+template Slice Slice::searchObjectKeyPrefetch<8>(StringRef const& attribute, ValueLength ieBase, ValueLength n) const;
+
+// template instanciations for searchObjectKeysBinary
+template ValueLength Slice::searchObjectKeysBinary<1>(StringRef const* attributes, std::size_t n, Slice* values, ValueLength ieBase, ValueLength entries) const;
+template ValueLength Slice::searchObjectKeysBinary<2>(StringRef const* attributes, std::size_t n, Slice* values, ValueLength ieBase, ValueLength entries) const;
+template ValueLength Slice::searchObjectKeysBinary<4>(StringRef const* attributes, std::size_t n, Slice* values, ValueLength ieBase, ValueLength entries) const;
+template ValueLength Slice::searchObjectKeysBinary<8>(StringRef const* attributes, std::size_t n, Slice* values, ValueLength ieBase, ValueLength entries) const;
+
 std::ostream& operator<<(std::ostream& stream, Slice const* slice) {
   stream << "[Slice " << valueTypeName(slice->type()) << " ("
          << slice->hexType() << "), byteSize: " << slice->byteSize() << "]";
@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/StreamBuilder.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// head byte and 8-byte byte length
+constexpr ValueLength headerSize = 1 + 8;
+
+// index table entries written to the sink at once
+constexpr std::size_t indexChunkEntries = 64;
+
+}  // namespace
+
+StreamBuilder::StreamBuilder(PatchableSink* sink, Options const* options)
+    : _sink(sink), _builder(options), _head(0), _start(0), _length(0) {
+  if (VELOCYPACK_UNLIKELY(sink == nullptr)) {
+    throw Exception(Exception::InternalError, "Sink cannot be a nullptr");
+  }
+}
+
+void StreamBuilder::openArray() { open(0x09); }
+
+void StreamBuilder::openObject() { open(0x0e); }
+
+void StreamBuilder::add(Slice value) {
+  checkOpen(0x09);
+  flush();
+  writeHeader();
+  _offsets.push_back(_length);
+  write(value.start(), value.byteSize());
+}
+
+void StreamBuilder::add(StringRef key, Slice value) {
+  checkOpen(0x0e);
+  flush();
+  writeHeader();
+
+  uint8_t name[1 + 8];
+  ValueLength nameHeaderSize;
+  if (key.size() <= 126) {
+    name[0] = static_cast<uint8_t>(0x40 + key.size());
+    nameHeaderSize = 1;
+  } else {
+    name[0] = 0xbf;
+    storeUInt64(name + 1, key.size());
+    nameHeaderSize = 9;
+  }
+  _keys.push_back(Key{_length, _names.size(), key.size()});
+  _names.append(key.data(), key.size());
+  write(name, nameHeaderSize);
+  write(reinterpret_cast<uint8_t const*>(key.data()), key.size());
+  write(value.start(), value.byteSize());
+}
+
+void StreamBuilder::flush() {
+  if (_builder.isEmpty()) {
+    return;
+  }
+  if (VELOCYPACK_UNLIKELY(!_builder.isClosed())) {
+    throw Exception(Exception::BuilderNotSealed);
+  }
+  checkOpen(_head);
+
+  uint8_t const* start = _builder.start();
+  uint8_t const* end = start + _builder.size();
+  ValueLength values = 0;
+  for (uint8_t const* p = start; p < end; p += Slice(p).byteSize()) {
+    if (_head == 0x0e && (values & 1) == 0 && !Slice(p).isString()) {
+      throw Exception(Exception::BuilderKeyMustBeString);
+    }
+    ++values;
+  }
+  if (_head == 0x0e && (values & 1) != 0) {
+    throw Exception(Exception::BuilderKeyMustBeString,
+                    "Expecting a value for every key");
+  }
+
+  writeHeader();
+  values = 0;
+  for (uint8_t const* p = start; p < end; p += Slice(p).byteSize()) {
+    ValueLength const offset = _length + (p - start);
+    if (_head == 0x09) {
+      _offsets.push_back(offset);
+    } else if ((values & 1) == 0) {
+      StringRef const name = Slice(p).stringRef();
+      _keys.push_back(Key{offset, _names.size(), name.size()});
+      _names.append(name.data(), name.size());
+    }
+    ++values;
+  }
+
+  write(start, _builder.size());
+  _builder.clear();
+}
+
+void StreamBuilder::close() {
+  checkOpen(_head);
+  flush();
+
+  uint8_t const head = _head;
+  _head = 0;
+  if (_length == 0) {
+    // an empty container gets the usual one-byte notation
+    _sink->push_back(head == 0x09 ? 0x01 : 0x0a);
+    return;
+  }
+
+  bool duplicate = false;
+  if (head == 0x0e) {
+    char const* names = _names.data();
+    auto less = [names](Key const& a, Key const& b) {
+      int c = memcmp(names + a.nameStart, names + b.nameStart,
+                     (std::min)(a.nameLength, b.nameLength));
+      return (c < 0 || (c == 0 && a.nameLength < b.nameLength));
+    };
+    std::sort(_keys.begin(), _keys.end(), less);
+    if (_builder.options->checkAttributeUniqueness) {
+      duplicate = std::adjacent_find(_keys.begin(), _keys.end(),
+                                     [&less](Key const& a, Key const& b) {
+                                       return !less(a, b);
+                                     }) != _keys.end();
+    }
+  }
+
+  writeIndexTable(head == 0x0e);
+
+  uint8_t byteLength[8];
+  storeUInt64(byteLength, _length);
+  _sink->patch(_start + 1, reinterpret_cast<char const*>(byteLength), 8);
+
+  if (duplicate) {
+    throw Exception(Exception::DuplicateAttributeName);
+  }
+}
+
+void StreamBuilder::checkOpen(uint8_t head) const {
+  if (VELOCYPACK_UNLIKELY(_head == 0)) {
+    throw Exception(Exception::BuilderNeedOpenCompound);
+  }
+  if (VELOCYPACK_UNLIKELY(_head != head)) {
+    throw Exception(head == 0x09 ? Exception::BuilderNeedOpenArray
+                                 : Exception::BuilderNeedOpenObject);
+  }
+}
+
+void StreamBuilder::open(uint8_t head) {
+  if (VELOCYPACK_UNLIKELY(_head != 0)) {
+    throw Exception(Exception::BuilderNotSealed);
+  }
+  _builder.clear();
+  _offsets.clear();
+  _keys.clear();
+  _names.clear();
+  _head = head;
+  _length = 0;
+}
+
+void StreamBuilder::writeHeader() {
+  if (_length != 0) {
+    return;
+  }
+  _start = _sink->position();
+  uint8_t header[headerSize] = {_head};
+  // the byte length is patched by close()
+  _sink->append(reinterpret_cast<char const*>(header), headerSize);
+  _length = headerSize;
+}
+
+void StreamBuilder::write(uint8_t const* p, ValueLength size) {
+  _sink->append(reinterpret_cast<char const*>(p), size);
+  _length += size;
+}
+
+void StreamBuilder::writeIndexTable(bool isObject) {
+  std::size_t const n = isObject ? _keys.size() : _offsets.size();
+  uint8_t chunk[8 * indexChunkEntries];
+  for (std::size_t i = 0; i < n; i += indexChunkEntries) {
+    std::size_t const entries = (std::min)(n - i, indexChunkEntries);
+    for (std::size_t j = 0; j < entries; ++j) {
+      storeUInt64(chunk + 8 * j, isObject ? _keys[i + j].offset : _offsets[i + j]);
+    }
+    write(chunk, 8 * entries);
+  }
+  // the number of members follows the index table
+  storeUInt64(chunk, n);
+  write(chunk, 8);
+}
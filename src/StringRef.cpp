@@ -39,6 +39,7 @@ extern void* memrchr(void const* block, int c, std::size_t size);
 }
 
 StringRef::StringRef(Slice slice) {
+  slice = slice.resolveExternals();
   VELOCYPACK_ASSERT(slice.isString());
   ValueLength l;
   _data = slice.getString(l);
@@ -57,6 +58,7 @@ StringRef& StringRef::operator=(HashedStringRef const& other) noexcept {
   
 /// @brief create a StringRef from a VPack slice of type String
 StringRef& StringRef::operator=(Slice slice) {
+  slice = slice.resolveExternals();
   VELOCYPACK_ASSERT(slice.isString());
   ValueLength l;
   _data = slice.getString(l);
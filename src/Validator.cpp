@@ -508,7 +508,7 @@ void Validator::validateIndexedObject(uint8_t const* ptr, std::size_t length) {
       throw Exception(Exception::ValidatorInvalidLength, "Object index table is out of bounds");
     }
     
-    firstMember = ptr + byteSize;
+    firstMember = ptr + 1 + byteSizeLength;
   } else {
     // byte length = 1, 2 or 4
     nrItems = readIntegerNonEmpty<ValueLength>(ptr + 1 + byteSizeLength, byteSizeLength);
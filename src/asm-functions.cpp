@@ -25,6 +25,7 @@
 #include <iostream>
 #include <chrono>
 #include <cstring>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Utf8Helper.h"
@@ -35,12 +36,91 @@ using namespace arangodb::velocypack;
 
 namespace {
 
+inline int countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(value);
+#else
+  int n = 0;
+  while ((value & 1) == 0) {
+    value >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// SWAR helpers, operating on 8 bytes in a uint64_t. the result masks
+// have bit 0x80 set in each byte for which the condition holds, and
+// all other bits cleared
+
+uint64_t const LowBits = 0x7f7f7f7f7f7f7f7fULL;
+uint64_t const HighBits = 0x8080808080808080ULL;
+
+constexpr uint64_t repeatByte(uint8_t value) {
+  return 0x0101010101010101ULL * value;
+}
+
+// loads 8 bytes so that the first byte in memory is the least significant
+inline uint64_t loadEightBytes(uint8_t const* src) {
+  uint64_t value;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | src[i];
+  }
+#else
+  memcpy(&value, src, sizeof(value));
+#endif
+  return value;
+}
+
+inline uint64_t zeroBytes(uint64_t value) {
+  return ~(((value & LowBits) + LowBits) | value | LowBits);
+}
+
+inline uint64_t equalBytes(uint64_t value, uint8_t c) {
+  return zeroBytes(value ^ repeatByte(c));
+}
+
+// bytes < c, for c <= 0x80
+inline uint64_t lessBytes(uint64_t value, uint8_t c) {
+  return ~(((value & LowBits) + repeatByte(0x80 - c)) | value) & HighBits;
+}
+
+// quotes, backslashes and control characters
+inline uint64_t stringStopBytes(uint64_t value) {
+  return equalBytes(value, '"') | equalBytes(value, '\\') |
+         lessBytes(value, 0x20);
+}
+
+inline uint64_t nonWhiteSpaceBytes(uint64_t value) {
+  return ~(equalBytes(value, ' ') | equalBytes(value, '\t') |
+           equalBytes(value, '\n') | equalBytes(value, '\r')) &
+         HighBits;
+}
+
+// index of the first byte marked in a non-zero mask
+inline std::size_t firstMarkedByte(uint64_t mask) {
+  return static_cast<std::size_t>(countTrailingZeros(mask)) >> 3;
+}
+
 inline std::size_t JSONStringCopyC(uint8_t* dst, uint8_t const* src, std::size_t limit) {
   // Copy up to limit uint8_t from src to dst.
   // Stop at the first control character or backslash or double quote.
   // Report the number of bytes copied. May copy less bytes, for example
   // for alignment reasons.
   uint8_t const* end = src + limit;
+  while (end - src >= 8) {
+    uint64_t const mask = stringStopBytes(loadEightBytes(src));
+    if (mask != 0) {
+      std::size_t const x = firstMarkedByte(mask);
+      memcpy(dst, src, x);
+      return limit - (end - src) + x;
+    }
+    memcpy(dst, src, 8);
+    src += 8;
+    dst += 8;
+  }
   while (src < end && *src >= 32 && *src != '\\' && *src != '"') {
     *dst++ = *src++;
   }
@@ -54,6 +134,18 @@ inline std::size_t JSONStringCopyCheckUtf8C(uint8_t* dst, uint8_t const* src, st
   // Report the number of bytes copied. May copy less bytes, for example
   // for alignment reasons.
   uint8_t const* end = src + limit;
+  while (end - src >= 8) {
+    uint64_t const value = loadEightBytes(src);
+    uint64_t const mask = stringStopBytes(value) | (value & HighBits);
+    if (mask != 0) {
+      std::size_t const x = firstMarkedByte(mask);
+      memcpy(dst, src, x);
+      return limit - (end - src) + x;
+    }
+    memcpy(dst, src, 8);
+    src += 8;
+    dst += 8;
+  }
   while (src < end && *src >= 32 && *src != '\\' && *src != '"' &&
          *src < 0x80) {
     *dst++ = *src++;
@@ -65,14 +157,54 @@ inline std::size_t JSONSkipWhiteSpaceC(uint8_t const* src, std::size_t limit) {
   // Skip up to limit uint8_t from src as long as they are whitespace.
   // Advance ptr and return the number of skipped bytes.
   uint8_t const* end = src + limit;
+  while (end - src >= 8) {
+    uint64_t const mask = nonWhiteSpaceBytes(loadEightBytes(src));
+    if (mask != 0) {
+      return limit - (end - src) + firstMarkedByte(mask);
+    }
+    src += 8;
+  }
   while (src < end && (*src == ' ' || *src == '\t' || *src == '\n' || *src == '\r')) {
     src++;
   }
   return limit - (end - src);
 }
 
+inline std::size_t JSONSkipStringC(uint8_t const* src, std::size_t limit) {
+  // Skip up to limit uint8_t from src.
+  // Stop at the first control character or backslash or double quote.
+  // Report the number of bytes skipped.
+  uint8_t const* end = src + limit;
+  while (end - src >= 8) {
+    uint64_t const mask = stringStopBytes(loadEightBytes(src));
+    if (mask != 0) {
+      return limit - (end - src) + firstMarkedByte(mask);
+    }
+    src += 8;
+  }
+  while (src < end && *src >= 32 && *src != '\\' && *src != '"') {
+    src++;
+  }
+  return limit - (end - src);
+}
+
 inline bool ValidateUtf8StringC(uint8_t const* src, std::size_t limit) {
-  return Utf8Helper::isValidUtf8(src, static_cast<ValueLength>(limit));
+  // Skip blocks of 8 ASCII bytes and only run the state machine on the
+  // rest. A sequence cut off by an ASCII block fails validation of its
+  // own segment.
+  uint8_t const* end = src + limit;
+  uint8_t const* start = src;
+  while (end - src >= 8) {
+    if ((loadEightBytes(src) & HighBits) == 0) {
+      if (start != src &&
+          !Utf8Helper::isValidUtf8(start, static_cast<ValueLength>(src - start))) {
+        return false;
+      }
+      start = src + 8;
+    }
+    src += 8;
+  }
+  return Utf8Helper::isValidUtf8(start, static_cast<ValueLength>(end - start));
 }
   
 } // namespace
@@ -98,7 +230,9 @@ bool hasSSE42() {
 #ifdef __AVX2__
 bool hasAVX2() {
   unsigned int eax, ebx, ecx, edx;
-  if (__get_cpuid(7, &eax, &ebx, &ecx, &edx)) {
+  // leaf 7 has sub-leaves, so ecx must be set as well
+  if (__get_cpuid_max(0, nullptr) >= 7) {
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
     if ((ebx & bit_AVX2) != 0) {
       return true;
     }
@@ -146,7 +280,46 @@ std::size_t JSONStringCopySSE42(uint8_t* dst, uint8_t const* src, std::size_t li
   return count;
 }
 
+#ifdef __AVX2__
+// returns a bit mask with one bit set for each of the 32 bytes at src that
+// is a double quote, a backslash or a control character
+VELOCYPACK_FORCE_INLINE uint32_t stringStopMaskAVX2(__m256i s) {
+  __m256i const quote = _mm256_cmpeq_epi8(s, _mm256_set1_epi8('"'));
+  __m256i const backslash = _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\\'));
+  // unsigned s <= 0x1f
+  __m256i const control =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(s, _mm256_set1_epi8(0x1f)), s);
+  return static_cast<uint32_t>(_mm256_movemask_epi8(
+      _mm256_or_si256(_mm256_or_si256(quote, backslash), control)));
+}
+
+std::size_t JSONStringCopyAVX2(uint8_t* dst, uint8_t const* src, std::size_t limit) {
+  std::size_t count = 0;
+  while (limit >= 32) {
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+    uint32_t const mask = stringStopMaskAVX2(s);
+    if (mask != 0) {
+      std::size_t const x = countTrailingZeros(mask);
+      memcpy(dst, src, x);
+      return count + x;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), s);
+    src += 32;
+    dst += 32;
+    limit -= 32;
+    count += 32;
+  }
+  return count + JSONStringCopySSE42(dst, src, limit);
+}
+#endif
+
 std::size_t doInitCopy(uint8_t* dst, uint8_t const* src, std::size_t limit) {
+#ifdef __AVX2__
+  if (assemblerFunctionsEnabled() && ::hasAVX2()) {
+    JSONStringCopy = ::JSONStringCopyAVX2;
+    return (*JSONStringCopy)(dst, src, limit);
+  }
+#endif
   if (assemblerFunctionsEnabled() && ::hasSSE42()) {
     JSONStringCopy = ::JSONStringCopySSE42;
   } else {
@@ -193,7 +366,37 @@ std::size_t JSONStringCopyCheckUtf8SSE42(uint8_t* dst, uint8_t const* src, std::
   return count;
 }
 
+#ifdef __AVX2__
+std::size_t JSONStringCopyCheckUtf8AVX2(uint8_t* dst, uint8_t const* src,
+                                       std::size_t limit) {
+  std::size_t count = 0;
+  while (limit >= 32) {
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+    // the sign bits of s mark all bytes >= 0x80
+    uint32_t const mask = stringStopMaskAVX2(s) |
+                          static_cast<uint32_t>(_mm256_movemask_epi8(s));
+    if (mask != 0) {
+      std::size_t const x = countTrailingZeros(mask);
+      memcpy(dst, src, x);
+      return count + x;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), s);
+    src += 32;
+    dst += 32;
+    limit -= 32;
+    count += 32;
+  }
+  return count + JSONStringCopyCheckUtf8SSE42(dst, src, limit);
+}
+#endif
+
 std::size_t doInitCopyCheckUtf8(uint8_t* dst, uint8_t const* src, std::size_t limit) {
+#ifdef __AVX2__
+  if (assemblerFunctionsEnabled() && ::hasAVX2()) {
+    JSONStringCopyCheckUtf8 = ::JSONStringCopyCheckUtf8AVX2;
+    return (*JSONStringCopyCheckUtf8)(dst, src, limit);
+  }
+#endif
   if (assemblerFunctionsEnabled() && ::hasSSE42()) {
     JSONStringCopyCheckUtf8 = ::JSONStringCopyCheckUtf8SSE42;
   } else {
@@ -234,7 +437,37 @@ std::size_t JSONSkipWhiteSpaceSSE42(uint8_t const* ptr, std::size_t limit) {
   return count;
 }
 
+#ifdef __AVX2__
+std::size_t JSONSkipWhiteSpaceAVX2(uint8_t const* ptr, std::size_t limit) {
+  __m256i const space = _mm256_set1_epi8(' ');
+  __m256i const tab = _mm256_set1_epi8('\t');
+  __m256i const nl = _mm256_set1_epi8('\n');
+  __m256i const cr = _mm256_set1_epi8('\r');
+  std::size_t count = 0;
+  while (limit >= 32) {
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr));
+    __m256i const white = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(s, space), _mm256_cmpeq_epi8(s, tab)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(s, nl), _mm256_cmpeq_epi8(s, cr)));
+    uint32_t const mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(white));
+    if (mask != 0) {
+      return count + countTrailingZeros(mask);
+    }
+    ptr += 32;
+    limit -= 32;
+    count += 32;
+  }
+  return count + JSONSkipWhiteSpaceSSE42(ptr, limit);
+}
+#endif
+
 std::size_t doInitSkip(uint8_t const* src, std::size_t limit) {
+#ifdef __AVX2__
+  if (assemblerFunctionsEnabled() && ::hasAVX2()) {
+    JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceAVX2;
+    return (*JSONSkipWhiteSpace)(src, limit);
+  }
+#endif
   if (assemblerFunctionsEnabled() && ::hasSSE42()) {
     JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceSSE42;
   } else {
@@ -243,6 +476,48 @@ std::size_t doInitSkip(uint8_t const* src, std::size_t limit) {
   return (*JSONSkipWhiteSpace)(src, limit);
 }
 
+std::size_t JSONSkipStringSSE42(uint8_t const* ptr, std::size_t limit) {
+  alignas(16) static char const ranges[17] =
+      "\x20\x21\x23\x5b\x5d\xff          ";
+  __m128i const r = _mm_load_si128(reinterpret_cast<__m128i const*>(ranges));
+  std::size_t count = 0;
+  int x = 0;
+  while (limit >= 16) {
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr));
+    x = _mm_cmpistri(r, /* 6, */ s, /* 16, */
+                     _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                         _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+    if (x < 16) {
+      count += x;
+      return count;
+    }
+    ptr += 16;
+    limit -= 16;
+    count += 16;
+  }
+  if (limit == 0) {
+    return count;
+  }
+  __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr));
+  x = _mm_cmpistri(r, /* 6, */ s, /* limit, */
+                   _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                       _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+  if (static_cast<std::size_t>(x) > limit) {
+    x = static_cast<int>(limit);
+  }
+  count += x;
+  return count;
+}
+
+std::size_t doInitSkipString(uint8_t const* src, std::size_t limit) {
+  if (assemblerFunctionsEnabled() && ::hasSSE42()) {
+    JSONSkipString = ::JSONSkipStringSSE42;
+  } else {
+    JSONSkipString = ::JSONSkipStringC;
+  }
+  return (*JSONSkipString)(src, limit);
+}
+
 #ifdef __AVX2__
 bool ValidateUtf8StringAVX(uint8_t const* src, std::size_t len) {
   if (len >= 32) {
@@ -293,6 +568,11 @@ std::size_t doInitSkip(uint8_t const* src, std::size_t limit) {
   JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceC;
   return JSONSkipWhiteSpace(src, limit);
 }
+
+std::size_t doInitSkipString(uint8_t const* src, std::size_t limit) {
+  JSONSkipString = ::JSONSkipStringC;
+  return JSONSkipString(src, limit);
+}
   
 bool doInitValidateUtf8String(uint8_t const* src, std::size_t limit) {
   ValidateUtf8String = ::ValidateUtf8StringC;
@@ -306,23 +586,98 @@ bool doInitValidateUtf8String(uint8_t const* src, std::size_t limit) {
 std::size_t (*JSONStringCopy)(uint8_t*, uint8_t const*, std::size_t) = ::doInitCopy;
 std::size_t (*JSONStringCopyCheckUtf8)(uint8_t*, uint8_t const*, std::size_t) = ::doInitCopyCheckUtf8;
 std::size_t (*JSONSkipWhiteSpace)(uint8_t const*, std::size_t) = ::doInitSkip;
+std::size_t (*JSONSkipString)(uint8_t const*, std::size_t) = ::doInitSkipString;
 bool (*ValidateUtf8String)(uint8_t const*, std::size_t) = ::doInitValidateUtf8String;
 
 void arangodb::velocypack::enableNativeStringFunctions() {
   JSONStringCopy = ::doInitCopy;
   JSONStringCopyCheckUtf8 = ::doInitCopyCheckUtf8;
   JSONSkipWhiteSpace = ::doInitSkip;
+  JSONSkipString = ::doInitSkipString;
 }
 
 void arangodb::velocypack::enableBuiltinStringFunctions() {
   JSONStringCopy = ::JSONStringCopyC;
   JSONStringCopyCheckUtf8 = ::JSONStringCopyCheckUtf8C;
   JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceC;
+  JSONSkipString = ::JSONSkipStringC;
 }
 
 
 #if defined(COMPILE_VELOCYPACK_ASM_UNITTESTS)
 
+template <typename F>
+struct Variant {
+  char const* name;
+  F func;
+};
+
+typedef std::size_t (*CopyFunc)(uint8_t*, uint8_t const*, std::size_t);
+typedef std::size_t (*SkipFunc)(uint8_t const*, std::size_t);
+
+// all implementations available on this machine, slowest first
+std::vector<Variant<CopyFunc>> stringCopyVariants() {
+  std::vector<Variant<CopyFunc>> result{{"C", ::JSONStringCopyC}};
+#if defined(__SSE4_2__) && ASM_OPTIMIZATIONS == 1
+  if (::hasSSE42()) {
+    result.push_back({"SSE4.2", ::JSONStringCopySSE42});
+  }
+#ifdef __AVX2__
+  if (::hasAVX2()) {
+    result.push_back({"AVX2", ::JSONStringCopyAVX2});
+  }
+#endif
+#endif
+  return result;
+}
+
+std::vector<Variant<CopyFunc>> stringCopyCheckUtf8Variants() {
+  std::vector<Variant<CopyFunc>> result{{"C", ::JSONStringCopyCheckUtf8C}};
+#if defined(__SSE4_2__) && ASM_OPTIMIZATIONS == 1
+  if (::hasSSE42()) {
+    result.push_back({"SSE4.2", ::JSONStringCopyCheckUtf8SSE42});
+  }
+#ifdef __AVX2__
+  if (::hasAVX2()) {
+    result.push_back({"AVX2", ::JSONStringCopyCheckUtf8AVX2});
+  }
+#endif
+#endif
+  return result;
+}
+
+std::vector<Variant<SkipFunc>> skipWhiteSpaceVariants() {
+  std::vector<Variant<SkipFunc>> result{{"C", ::JSONSkipWhiteSpaceC}};
+#if defined(__SSE4_2__) && ASM_OPTIMIZATIONS == 1
+  if (::hasSSE42()) {
+    result.push_back({"SSE4.2", ::JSONSkipWhiteSpaceSSE42});
+  }
+#ifdef __AVX2__
+  if (::hasAVX2()) {
+    result.push_back({"AVX2", ::JSONSkipWhiteSpaceAVX2});
+  }
+#endif
+#endif
+  return result;
+}
+
+typedef bool (*ValidateFunc)(uint8_t const*, std::size_t);
+
+std::vector<Variant<ValidateFunc>> validateUtf8Variants() {
+  std::vector<Variant<ValidateFunc>> result{{"C", ::ValidateUtf8StringC}};
+#if defined(__SSE4_2__) && ASM_OPTIMIZATIONS == 1
+  if (::hasSSE42()) {
+    result.push_back({"SSE4.2", ::ValidateUtf8StringSSE42});
+  }
+#ifdef __AVX2__
+  if (::hasAVX2()) {
+    result.push_back({"AVX2", ::ValidateUtf8StringAVX});
+  }
+#endif
+#endif
+  return result;
+}
+
 int testPositions[] = {
     0,   1,   2,   3,   4,   5,   6,    7,    8,    9,    10,   11,   12,  13,
     14,  15,  16,  23,  31,  32,  67,   103,  178,  210,  234,  247,  254, 255,
@@ -531,6 +886,55 @@ void TestSkipWhiteSpaceCorrectness(uint8_t* src, std::size_t size) {
             << " seconds." << std::endl;
 }
 
+void TestValidateUtf8Correctness(uint8_t* src, std::size_t size) {
+  std::cout << "Performing correctness tests for UTF-8 validation..."
+            << std::endl;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // replacement bytes: an invalid byte, a lead byte without continuation,
+  // a stray continuation byte and plain ASCII cutting off a sequence
+  uint8_t const replacements[] = {0xff, 0xe2, 0x80, 'a'};
+
+  for (int salign = 0; salign < 16; salign++) {
+    src += salign;
+    if (ValidateUtf8String(src, size) != Utf8Helper::isValidUtf8(src, size)) {
+      std::cout << "Error: " << salign << std::endl;
+    }
+    for (int i = 0; i < static_cast<int>(sizeof(testPositions) / sizeof(int));
+         i++) {
+      int off = testPositions[i];
+      std::size_t pos;
+      if (off >= 0) {
+        pos = off;
+      } else {
+        pos = size - static_cast<std::size_t>(-off);
+      }
+      if (pos >= size) {
+        continue;
+      }
+
+      uint8_t merk = src[pos];
+      for (uint8_t r : replacements) {
+        src[pos] = r;
+        bool expected = Utf8Helper::isValidUtf8(src, size);
+        if (ValidateUtf8String(src, size) != expected) {
+          std::cout << "Error: " << salign << " " << i << " " << pos << " "
+                    << static_cast<int>(r) << " " << expected << std::endl;
+        }
+      }
+      src[pos] = merk;
+    }
+    src -= salign;
+  }
+
+  auto now = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> totalTime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(now - start);
+  std::cout << "UTF-8 tests took altogether " << totalTime.count()
+            << " seconds." << std::endl;
+}
+
 void RaceStringCopy(uint8_t* dst, uint8_t* src, std::size_t size, int repeat,
                     uint64_t& akku) {
   std::size_t copied;
@@ -591,7 +995,7 @@ void RaceStringCopyCheckUtf8(uint8_t* dst, uint8_t* src, std::size_t size,
   src[size] = 0;
   auto start = std::chrono::high_resolution_clock::now();
   for (int j = 0; j < repeat; j++) {
-    copied = JSONStringCopy(dst, src, size);
+    copied = JSONStringCopyCheckUtf8(dst, src, size);
     akku = akku * 13 + copied;
   }
   auto now = std::chrono::high_resolution_clock::now();
@@ -615,7 +1019,7 @@ void RaceStringCopyCheckUtf8(uint8_t* dst, uint8_t* src, std::size_t size,
   dst++;
   start = std::chrono::high_resolution_clock::now();
   for (int j = 0; j < repeat; j++) {
-    copied = JSONStringCopy(dst, src, size);
+    copied = JSONStringCopyCheckUtf8(dst, src, size);
     akku = akku * 13 + copied;
   }
   now = std::chrono::high_resolution_clock::now();
@@ -660,6 +1064,7 @@ void RaceSkipWhiteSpace(uint8_t* src, std::size_t size, int repeat, uint64_t& ak
 
   auto start = std::chrono::high_resolution_clock::now();
   akku = 0;
+  uint8_t const last = src[size];
   src[size] = 0;
   for (int j = 0; j < repeat; j++) {
     copied = JSONSkipWhiteSpace(src, size);
@@ -680,6 +1085,7 @@ void RaceSkipWhiteSpace(uint8_t* src, std::size_t size, int repeat, uint64_t& ak
 
   std::cout << "\nNow comparing with strlen...\n" << std::endl;
 
+  uint8_t const first = src[0];
   start = std::chrono::high_resolution_clock::now();
   for (int j = 0; j < repeat; j++) {
     copied = strlen((char*)src);
@@ -688,6 +1094,8 @@ void RaceSkipWhiteSpace(uint8_t* src, std::size_t size, int repeat, uint64_t& ak
     akku = akku * 13 + copied;
   }
   now = std::chrono::high_resolution_clock::now();
+  src[0] = first;
+  src[size] = last;
 
   totalTime =
       std::chrono::duration_cast<std::chrono::duration<double>>(now - start);
@@ -724,19 +1132,29 @@ int main(int argc, char* argv[]) {
   }
   src[size + 16] = 0;
 
-  if (docorrectness > 0) {
-    TestStringCopyCorrectness(src, dst, size);
-  }
+  for (auto const& variant : stringCopyVariants()) {
+    std::cout << "\n\n\nSTRING COPY, VARIANT " << variant.name << "\n"
+              << std::endl;
+    JSONStringCopy = variant.func;
 
-  RaceStringCopy(dst, src, size, repeat, akku);
+    if (docorrectness > 0) {
+      TestStringCopyCorrectness(src, dst, size);
+    }
 
-  if (docorrectness > 0) {
-    TestStringCopyCorrectnessCheckUtf8(src, dst, size);
+    RaceStringCopy(dst, src, size, repeat, akku);
   }
 
-  RaceStringCopyCheckUtf8(dst, src, size, repeat, akku);
+  for (auto const& variant : stringCopyCheckUtf8Variants()) {
+    std::cout << "\n\n\nSTRING COPY (CHECK UTF8), VARIANT " << variant.name
+              << "\n" << std::endl;
+    JSONStringCopyCheckUtf8 = variant.func;
+
+    if (docorrectness > 0) {
+      TestStringCopyCorrectnessCheckUtf8(src, dst, size);
+    }
 
-  std::cout << "\n\n\nNOW WHITESPACE SKIPPING\n" << std::endl;
+    RaceStringCopyCheckUtf8(dst, src, size, repeat, akku);
+  }
 
   // Now do the whitespace skipping tests/measurements:
   static char const whitetab[17] = "       \t   \n   \r";
@@ -745,11 +1163,32 @@ int main(int argc, char* argv[]) {
   }
   src[size + 16] = 0;
 
-  if (docorrectness > 0) {
-    TestSkipWhiteSpaceCorrectness(src, size);
+  for (auto const& variant : skipWhiteSpaceVariants()) {
+    std::cout << "\n\n\nWHITESPACE SKIPPING, VARIANT " << variant.name << "\n"
+              << std::endl;
+    JSONSkipWhiteSpace = variant.func;
+
+    if (docorrectness > 0) {
+      TestSkipWhiteSpaceCorrectness(src, size);
+    }
+
+    RaceSkipWhiteSpace(src, size, repeat, akku);
   }
 
-  RaceSkipWhiteSpace(src, size, repeat, akku);
+  // Now check UTF-8 validation on a mix of 1 to 4 byte sequences:
+  static char const utf8tab[] = "abc\xc3\xa4\xe2\x82\xacxyz\xf0\x9d\x84\x9e!";
+  for (std::size_t i = 0; i < size + 16; i++) {
+    src[i] = utf8tab[i % (sizeof(utf8tab) - 1)];
+  }
+
+  if (docorrectness > 0) {
+    for (auto const& variant : validateUtf8Variants()) {
+      std::cout << "\n\n\nUTF-8 VALIDATION, VARIANT " << variant.name << "\n"
+                << std::endl;
+      ValidateUtf8String = variant.func;
+      TestValidateUtf8Correctness(src, size);
+    }
+  }
 
   std::cout << "\n\n\nAkku (please ignore):" << akku << std::endl;
   std::cout << "\n\n\nGuck (please ignore): " << dst[100] << std::endl;
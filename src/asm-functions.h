@@ -35,6 +35,10 @@ extern std::size_t (*JSONStringCopyCheckUtf8)(uint8_t*, uint8_t const*, std::siz
 // White space skipping:
 extern std::size_t (*JSONSkipWhiteSpace)(uint8_t const*, std::size_t);
 
+// String skipping, stops at the same bytes as JSONStringCopy but does
+// not copy anything:
+extern std::size_t (*JSONSkipString)(uint8_t const*, std::size_t);
+
 // check string for invalid utf-8 sequences
 extern bool (*ValidateUtf8String)(uint8_t const*, std::size_t);
 
@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_FAST_FLOAT_H
+#define VELOCYPACK_FAST_FLOAT_H 1
+
+#include <cstdint>
+#include <cstddef>
+
+namespace arangodb {
+namespace velocypack {
+
+// Converts mantissa * 10^exponent into the nearest double, using
+// Clinger's fast path or the Eisel-Lemire algorithm. Returns false if
+// the result cannot be determined this way, in which case the caller
+// must fall back to parseDoubleSlow().
+bool decimalToDouble(uint64_t mantissa, int64_t exponent, double& result) noexcept;
+
+// Converts a syntactically valid JSON number into a double with
+// strtod(), independent of the current locale's decimal point.
+double parseDoubleSlow(char const* p, std::size_t length);
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
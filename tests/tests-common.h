@@ -1,10 +1,13 @@
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AttributePath.h"
 #include "velocypack/AttributeTranslator.h"
+#include "velocypack/BatchParser.h"
 #include "velocypack/Basics.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
+#include "velocypack/CompactIndex.h"
 #include "velocypack/Compare.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
@@ -13,9 +16,13 @@
 #include "velocypack/Iterator.h"
 #include "velocypack/Options.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Patcher.h"
+#include "velocypack/Projection.h"
+#include "velocypack/Reflection.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
+#include "velocypack/StreamBuilder.h"
 #include "velocypack/StringRef.h"
 #include "velocypack/Validator.h"
 #include "velocypack/Value.h"
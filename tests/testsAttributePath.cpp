@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace {
+
+std::shared_ptr<Builder> document(int i, std::string const& extra = std::string()) {
+  return Parser::fromJson("{\"_key\":\"k" + std::to_string(i) + "\"," + extra +
+                          "\"user\":{\"name\":\"n" + std::to_string(i) +
+                          "\",\"id\":" + std::to_string(i) + ",\"age\":42},"
+                          "\"tags\":[1,2],\"x\":1,\"y\":2}");
+}
+
+} // namespace
+
+TEST(AttributePathTest, Empty) {
+  ASSERT_VELOCYPACK_EXCEPTION(AttributePath(std::vector<std::string>()),
+                              Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(AttributePath(std::vector<StringRef>()),
+                              Exception::InvalidAttributePath);
+}
+
+TEST(AttributePathTest, NonObject) {
+  AttributePath path{"a"};
+  ASSERT_EQ(1U, path.size());
+  ASSERT_VELOCYPACK_EXCEPTION(path.get(Parser::fromJson("[1]")->slice()),
+                              Exception::InvalidValueType);
+}
+
+TEST(AttributePathTest, SameLayout) {
+  AttributePath path{"user", "id"};
+  ASSERT_EQ(2U, path.size());
+
+  for (int i = 0; i < 100; ++i) {
+    auto b = document(i);
+    Slice value = path.get(b->slice());
+    ASSERT_EQ(b->slice().get(std::vector<std::string>{"user", "id"}).start(),
+              value.start());
+    ASSERT_EQ(i, value.getInt());
+  }
+  // only the first document was searched
+  ASSERT_EQ(2U, path.misses());
+  ASSERT_EQ(198U, path.hits());
+}
+
+TEST(AttributePathTest, ChangingLayout) {
+  AttributePath path(std::vector<StringRef>{StringRef("user"), StringRef("name")});
+
+  for (int i = 0; i < 20; ++i) {
+    // every other document has an extra attribute that moves "user"
+    // to another position in the index table
+    auto b = document(i, (i % 2) ? "\"b\":true," : "");
+    Slice value = path.get(b->slice());
+    ASSERT_EQ("n" + std::to_string(i), value.copyString());
+  }
+  // "user" moves every time, "name" stays where it was found first
+  ASSERT_EQ(21U, path.misses());
+  ASSERT_EQ(19U, path.hits());
+}
+
+TEST(AttributePathTest, NotFound) {
+  auto b = document(1);
+
+  AttributePath missing{"user", "email"};
+  ASSERT_TRUE(missing.get(b->slice()).isNone());
+  ASSERT_TRUE(missing.get(b->slice()).isNone());
+
+  AttributePath throughArray{"tags", "a"};
+  ASSERT_TRUE(throughArray.get(b->slice()).isNone());
+
+  AttributePath throughEmpty{"e", "a"};
+  ASSERT_TRUE(throughEmpty.get(Parser::fromJson("{\"e\":{}}")->slice()).isNone());
+}
+
+TEST(AttributePathTest, CompactObjects) {
+  Options options;
+  options.buildUnindexedObjects = true;
+
+  AttributePath path{"a", "c"};
+  for (int i = 0; i < 3; ++i) {
+    auto b = Parser::fromJson("{\"a\":{\"b\":1,\"c\":" + std::to_string(i) + "},\"d\":2}", &options);
+    ASSERT_EQ(0x14, b->slice().head());
+    ASSERT_EQ(i, path.get(b->slice()).getInt());
+  }
+  ASSERT_EQ(6U, path.misses());
+  ASSERT_EQ(0U, path.hits());
+}
+
+TEST(AttributePathTest, TranslatedKeys) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+
+  AttributePath path{"foo", "baz"};
+  for (int i = 0; i < 3; ++i) {
+    Builder b(&options);
+    b.openObject();
+    b.add("bar", Value(false));
+    b.add("foo", Value(ValueType::Object));
+    b.add("bar", Value(1));
+    b.add("baz", Value(i));
+    b.add("qux", Value(3));
+    b.add("quux", Value(4));
+    b.close();
+    b.add("zzz", Value(true));
+    b.add("aaa", Value(true));
+    b.close();
+
+    ASSERT_EQ(i, path.get(b.slice()).getInt());
+  }
+  ASSERT_EQ(2U, path.misses());
+  ASSERT_EQ(4U, path.hits());
+}
+
+TEST(AttributePathTest, AgainstGet) {
+  std::vector<std::vector<std::string>> paths{
+      {"_key"}, {"user"}, {"user", "age"}, {"user", "name"}, {"x"}, {"y"}, {"z"}};
+
+  std::vector<AttributePath> compiled;
+  for (auto const& p : paths) {
+    compiled.emplace_back(p);
+  }
+
+  for (int i = 0; i < 50; ++i) {
+    std::string extra;
+    for (int j = 0; j < i % 5; ++j) {
+      extra += "\"e" + std::to_string(j) + "\":" + std::to_string(j) + ",";
+    }
+    auto b = document(i, extra);
+    for (std::size_t j = 0; j < paths.size(); ++j) {
+      ASSERT_EQ(b->slice().get(paths[j]).start(), compiled[j].get(b->slice()).start());
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
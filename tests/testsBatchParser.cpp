@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+#include "tests-common.h"
+
+// builds NDJSON input with the given number of documents
+static std::string buildInput(std::size_t count) {
+  std::string value;
+  for (std::size_t i = 0; i < count; ++i) {
+    value.append("{\"id\":" + std::to_string(i) + ",\"name\":\"");
+    value.append(std::string(i % 100, 'x'));
+    value.append("\",\"values\":[1.5,-2,true,null,\"a\\nb\"]}");
+    value.push_back('\n');
+    if (i % 7 == 0) {
+      // empty lines are allowed
+      value.append("\r\n  \n");
+    }
+  }
+  return value;
+}
+
+// compares the result with the one of a single-threaded parse
+static void checkBatch(BatchParser const& batch, std::string const& value) {
+  Parser parser;
+  ValueLength count = parser.parse(value, true);
+  ASSERT_EQ(count, batch.size());
+
+  uint8_t const* p = parser.start();
+  for (ValueLength i = 0; i < count; ++i) {
+    Slice expected(p);
+    ASSERT_EQ(expected.byteSize(), batch[i].byteSize());
+    ASSERT_EQ(0, memcmp(expected.start(), batch[i].start(), expected.byteSize()));
+    p += expected.byteSize();
+  }
+}
+
+TEST(BatchParserTest, NoOptions) {
+  ASSERT_VELOCYPACK_EXCEPTION(BatchParser(nullptr), Exception::InternalError);
+}
+
+TEST(BatchParserTest, DefaultThreads) {
+  BatchParser batch;
+  ASSERT_LE(1UL, batch.threads());
+}
+
+TEST(BatchParserTest, Empty) {
+  BatchParser batch(&Options::Defaults, 4);
+  ASSERT_VELOCYPACK_EXCEPTION(batch.parse(""), Exception::ParseError);
+  ASSERT_VELOCYPACK_EXCEPTION(batch.parse(" \n \n"), Exception::ParseError);
+}
+
+TEST(BatchParserTest, Single) {
+  BatchParser batch(&Options::Defaults, 4);
+  ASSERT_EQ(1ULL, batch.parse("{\"a\":1}\n"));
+  ASSERT_EQ(1ULL, batch.size());
+  ASSERT_EQ(1ULL, batch.offsets().size());
+  ASSERT_EQ(0ULL, batch.offsets()[0]);
+  ASSERT_EQ(1, batch[0].get("a").getInt());
+  ASSERT_VELOCYPACK_EXCEPTION(batch.at(1), Exception::IndexOutOfBounds);
+}
+
+TEST(BatchParserTest, SeveralValuesPerLine) {
+  std::string const value("1 2 3\n[4] {\"5\":5}\n\"6\"");
+
+  BatchParser batch(&Options::Defaults, 2);
+  ASSERT_EQ(6ULL, batch.parse(value));
+  checkBatch(batch, value);
+}
+
+TEST(BatchParserTest, ThreadCounts) {
+  std::string const value = buildInput(20000);
+
+  for (std::size_t threads : {1, 2, 3, 8, 64}) {
+    BatchParser batch(&Options::Defaults, threads);
+    ASSERT_EQ(20000ULL, batch.parse(value));
+    checkBatch(batch, value);
+  }
+}
+
+TEST(BatchParserTest, Reuse) {
+  BatchParser batch(&Options::Defaults, 4);
+  std::string value = buildInput(20000);
+  ASSERT_EQ(20000ULL, batch.parse(value));
+  value = buildInput(100);
+  ASSERT_EQ(100ULL, batch.parse(value));
+  checkBatch(batch, value);
+}
+
+TEST(BatchParserTest, WorkersAreReused) {
+  BatchParser batch(&Options::Defaults, 4);
+  std::string const small("1\n2\n");
+  ASSERT_EQ(2ULL, batch.parse(small));
+  // small inputs are parsed by the calling thread only
+  ASSERT_EQ(0UL, batch.workers());
+
+  std::string value = buildInput(20000);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(20000ULL, batch.parse(value));
+    checkBatch(batch, value);
+    ASSERT_EQ(3UL, batch.workers());
+  }
+
+  // and after an error
+  std::string broken = value;
+  broken[broken.find("{\"id\":15000,") + 5] = '=';
+  ASSERT_VELOCYPACK_EXCEPTION(batch.parse(broken), Exception::ParseError);
+  ASSERT_EQ(20000ULL, batch.parse(value));
+  checkBatch(batch, value);
+  ASSERT_EQ(3UL, batch.workers());
+}
+
+TEST(BatchParserTest, ToArray) {
+  std::string const value = buildInput(20000);
+
+  BatchParser batch(&Options::Defaults, 4);
+  batch.parse(value);
+
+  Builder builder;
+  batch.toArray(builder);
+  Slice s = builder.slice();
+  ASSERT_TRUE(s.isArray());
+  ASSERT_EQ(20000ULL, s.length());
+  for (ValueLength i = 0; i < s.length(); ++i) {
+    ASSERT_EQ(i, s.at(i).get("id").getUInt());
+  }
+}
+
+TEST(BatchParserTest, ErrorPosition) {
+  std::string value = buildInput(20000);
+  // break a document in the second half of the input
+  std::size_t pos = value.find("{\"id\":15000,");
+  ASSERT_NE(std::string::npos, pos);
+  value[pos + 5] = '=';
+
+  Parser parser;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse(value, true), Exception::ParseError);
+
+  for (std::size_t threads : {1, 4}) {
+    BatchParser batch(&Options::Defaults, threads);
+    ASSERT_VELOCYPACK_EXCEPTION(batch.parse(value), Exception::ParseError);
+    ASSERT_EQ(parser.errorPos(), batch.errorPos());
+  }
+}
+
+TEST(BatchParserTest, FirstErrorIsReported) {
+  std::string value = buildInput(20000);
+  std::size_t first = value.find("{\"id\":1000,");
+  std::size_t second = value.find("{\"id\":19000,");
+  value[first] = ']';
+  value[second] = ']';
+
+  Parser parser;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse(value, true), Exception::ParseError);
+  ASSERT_LT(parser.errorPos(), second);
+
+  BatchParser batch(&Options::Defaults, 8);
+  ASSERT_VELOCYPACK_EXCEPTION(batch.parse(value), Exception::ParseError);
+  ASSERT_EQ(parser.errorPos(), batch.errorPos());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -26,6 +26,7 @@
 
 #include <ostream>
 #include <string>
+#include <utility>
 #include <iostream>
 
 #include "tests-common.h"
@@ -536,6 +537,53 @@ TEST(BufferTest, BufferNonDeleterTest) {
   ASSERT_EQ(2308, buffer.size());
 }
 
+TEST(BufferTest, ReallocationsTest) {
+  Buffer<uint8_t> buffer;
+  ASSERT_EQ(0U, buffer.reallocations());
+
+  buffer.append(std::string(100, 'x'));
+  ASSERT_EQ(0U, buffer.reallocations());
+  buffer.append(std::string(200, 'x'));
+  ASSERT_EQ(1U, buffer.reallocations());
+  buffer.reserve(100000);
+  ASSERT_EQ(2U, buffer.reallocations());
+  buffer.append(std::string(10000, 'x'));
+  ASSERT_EQ(2U, buffer.reallocations());
+
+  Buffer<uint8_t> other(std::move(buffer));
+  ASSERT_EQ(2U, other.reallocations());
+  ASSERT_EQ(0U, buffer.reallocations());
+
+  other.reset();
+  ASSERT_EQ(2U, other.reallocations());
+  other.clear();
+  ASSERT_EQ(0U, other.reallocations());
+}
+
+TEST(BufferTest, ReallocationsPresized) {
+  Buffer<uint8_t> buffer(100000);
+  ASSERT_FALSE(buffer.usesLocalMemory());
+  ASSERT_EQ(0U, buffer.reallocations());
+
+  buffer.append(std::string(10000, 'x'));
+  ASSERT_EQ(0U, buffer.reallocations());
+}
+
+TEST(BufferTest, StealChecked) {
+  static_assert(noexcept(std::declval<Buffer<uint8_t>&>().steal()),
+                "steal() must not throw");
+
+  Buffer<uint8_t> buffer;
+  buffer.append(std::string(1000, 'x'));
+  ASSERT_FALSE(buffer.usesLocalMemory());
+
+  uint8_t* p = buffer.stealChecked();
+  ASSERT_EQ('x', p[999]);
+  ASSERT_TRUE(buffer.usesLocalMemory());
+  ASSERT_EQ(0U, buffer.size());
+  velocypack_free(p);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -24,10 +24,15 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <array>
+#include <functional>
 #include <iostream>
 #include <ostream>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "tests-common.h"
 
@@ -1291,6 +1296,177 @@ TEST(BuilderTest, ObjectSorted) {
   ASSERT_EQ(0, memcmp(result, correctResult, len));
 }
 
+TEST(BuilderTest, ObjectSortedLarge) {
+  // keys share long common prefixes, some contain zero bytes and
+  // some are prefixes of others
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i < 2000; ++i) {
+    std::string key("tenant-");
+    key.append(std::to_string(i % 37));
+    if (i % 3 == 0) {
+      key.push_back('\0');
+    }
+    key.append(std::to_string(i));
+    keys.push_back(key);
+  }
+  keys.push_back("t");
+  keys.push_back("tenant-");
+  keys.push_back(std::string("tenant-\0", 8));
+
+  std::vector<std::string> sortedKeys(keys);
+  std::sort(sortedKeys.begin(), sortedKeys.end());
+
+  auto check = [&sortedKeys](std::vector<std::string> const& order) {
+    Builder b;
+    b.openObject();
+    for (auto const& key : order) {
+      b.add(key, Value(key.size()));
+    }
+    b.close();
+
+    Slice s = b.slice();
+    ASSERT_TRUE(s.isObject());
+    ASSERT_EQ(sortedKeys.size(), s.length());
+    for (std::size_t i = 0; i < sortedKeys.size(); ++i) {
+      ASSERT_EQ(sortedKeys[i], s.keyAt(i).copyString());
+      ASSERT_EQ(sortedKeys[i].size(), s.get(sortedKeys[i]).getUInt());
+    }
+  };
+
+  check(sortedKeys);
+  std::vector<std::string> reversedKeys(sortedKeys.rbegin(), sortedKeys.rend());
+  check(reversedKeys);
+  check(keys);
+  std::mt19937 gen(42);
+  std::shuffle(keys.begin(), keys.end(), gen);
+  check(keys);
+}
+
+TEST(BuilderTest, ObjectClosePresorted) {
+  Builder sorted;
+  sorted.openObject();
+  Builder presorted;
+  presorted.openObject();
+  for (std::size_t i = 0; i < 100; ++i) {
+    std::string const key = "key" + std::to_string(1000 + i);
+    sorted.add(key, Value(i));
+    presorted.add(key, Value(i));
+  }
+  sorted.close();
+  presorted.closePresorted();
+
+  ASSERT_EQ(sorted.size(), presorted.size());
+  ASSERT_EQ(0, memcmp(sorted.start(), presorted.start(), sorted.size()));
+  ASSERT_EQ(42UL, presorted.slice().get("key1042").getUInt());
+
+  // arrays are closed as usual
+  Builder b;
+  b.openArray();
+  b.add(Value(1));
+  b.add(Value(2));
+  b.closePresorted();
+  ASSERT_TRUE(b.isClosed());
+  ASSERT_EQ(2UL, b.slice().length());
+}
+
+TEST(BuilderTest, AddSlices) {
+  std::vector<std::shared_ptr<Builder>> children;
+  children.push_back(Parser::fromJson("{\"a\":1}"));
+  children.push_back(Parser::fromJson("\"foo\""));
+  children.push_back(Parser::fromJson("[1,2,3]"));
+  std::vector<Slice> slices;
+  for (auto const& child : children) {
+    slices.push_back(child->slice());
+  }
+
+  for (bool compact : {false, true}) {
+    Builder b;
+    b.openArray(compact);
+    b.add(Value(0));
+    b.addSlices(slices.data(), slices.size());
+    b.add(Value(4));
+    b.close();
+    ASSERT_EQ("[0,{\"a\":1},\"foo\",[1,2,3],4]", b.slice().toJson());
+    ASSERT_EQ(3UL, b.slice().at(3).length());
+  }
+}
+
+TEST(BuilderTest, AddSequence) {
+  // a worker Builder holding several values at its top level
+  Builder child;
+  child.add(Value("first"));
+  child.openObject();
+  child.add("b", Value(true));
+  child.close();
+  child.add(Value(3.5));
+
+  Builder b;
+  b.openArray();
+  b.addSequence(child.start(), child.size());
+  b.addSequence(child.start(), child.size());
+  b.close();
+  ASSERT_EQ(6UL, b.slice().length());
+  ASSERT_EQ("[\"first\",{\"b\":true},3.5,\"first\",{\"b\":true},3.5]",
+            b.slice().toJson());
+
+  Builder o;
+  o.openObject();
+  ASSERT_VELOCYPACK_EXCEPTION(o.addSequence(child.start(), child.size()),
+                              Exception::BuilderNeedOpenArray);
+
+  // the last value is cut off
+  Builder a;
+  a.openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(a.addSequence(child.start(), child.size() - 1),
+                              Exception::BuilderUnexpectedValue);
+  a.close();
+  ASSERT_EQ(0UL, a.slice().length());
+}
+
+TEST(BuilderTest, AddUninitialized) {
+  std::vector<std::shared_ptr<Builder>> children;
+  std::vector<ValueLength> sizes;
+  for (std::size_t i = 0; i < 8; ++i) {
+    children.push_back(Parser::fromJson("{\"id\":" + std::to_string(i) +
+                                        ",\"name\":\"" + std::string(i * 10, 'x') + "\"}"));
+    sizes.push_back(children.back()->size());
+  }
+
+  Builder b;
+  b.openArray();
+  uint8_t* p = b.addUninitialized(sizes.data(), sizes.size());
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < children.size(); ++i) {
+    threads.emplace_back([&children, p, i]() {
+      ValueLength offset = 0;
+      for (std::size_t j = 0; j < i; ++j) {
+        offset += children[j]->size();
+      }
+      memcpy(p + offset, children[i]->start(), children[i]->size());
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(8UL, s.length());
+  for (std::size_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(i, s.at(i).get("id").getUInt());
+    ASSERT_EQ(i * 10, s.at(i).get("name").getStringLength());
+  }
+
+  ValueLength const empty = 0;
+  Builder e;
+  e.openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(e.addUninitialized(&empty, 1),
+                              Exception::BuilderUnexpectedValue);
+  Builder n;
+  ASSERT_VELOCYPACK_EXCEPTION(n.addUninitialized(sizes.data(), 1),
+                              Exception::BuilderNeedOpenArray);
+}
+
 TEST(BuilderTest, ObjectCompact) {
   double value = 2.3;
   Builder b;
@@ -1687,6 +1863,94 @@ TEST(BuilderTest, Int1Limits) {
   }
 }
 
+TEST(BuilderTest, TypedAddSameAsValue) {
+  int64_t ints[] = {0, 9, 10, -6, -7, -0x80LL, 0x7fLL, -0x81LL, 0x80LL,
+                    -0x8000000001LL, 0x8000000000LL, 0x7fffffffffffffffLL,
+                    arangodb::velocypack::toInt64(0x8000000000000000ULL)};
+  uint64_t uints[] = {0, 9, 10, 0xffULL, 0x100ULL, 0xffffffffULL,
+                      0x100000000ULL, 0xffffffffffffffffULL};
+  double doubles[] = {0.0, -1.5, 1.0e300};
+  std::string const longString(300, 'x');
+
+  Builder typed;
+  typed.openArray();
+  Builder values;
+  values.openArray();
+  for (auto v : ints) {
+    typed.add(v);
+    values.add(Value(v));
+  }
+  for (auto v : uints) {
+    typed.add(v);
+    values.add(Value(v));
+  }
+  for (auto v : doubles) {
+    typed.add(v);
+    values.add(Value(v));
+  }
+  typed.add(true);
+  values.add(Value(true));
+  typed.add(int8_t(-3));
+  values.add(Value(int64_t(-3)));
+  typed.add(uint16_t(1000));
+  values.add(Value(uint64_t(1000)));
+  typed.add(1.5f);
+  values.add(Value(1.5));
+  typed.add("foo");
+  values.add(Value("foo"));
+  typed.add(longString);
+  values.add(Value(longString));
+  typed.add(StringRef("bar"));
+  values.add(Value("bar"));
+  typed.close();
+  values.close();
+
+  ASSERT_EQ(values.size(), typed.size());
+  ASSERT_EQ(0, memcmp(values.start(), typed.start(), values.size()));
+}
+
+TEST(BuilderTest, TypedAddObject) {
+  std::string const key("uint");
+  Builder b;
+  b.openObject();
+  b.add("int", -42);
+  b.add(key, 42U);
+  b.add(StringRef("double"), 2.5);
+  b.add("bool", false);
+  b.add("string", "value");
+  b.add("key", key);
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(6UL, s.length());
+  ASSERT_EQ(-42, s.get("int").getInt());
+  ASSERT_TRUE(s.get("uint").isUInt());
+  ASSERT_EQ(42UL, s.get("uint").getUInt());
+  ASSERT_EQ(2.5, s.get("double").getDouble());
+  ASSERT_FALSE(s.get("bool").getBool());
+  ASSERT_EQ("value", s.get("string").copyString());
+  ASSERT_EQ("uint", s.get("key").copyString());
+}
+
+TEST(BuilderTest, TypedAddObjectErrors) {
+  Builder b;
+  b.openObject();
+  ASSERT_VELOCYPACK_EXCEPTION(b.add(1), Exception::BuilderKeyMustBeString);
+  ASSERT_VELOCYPACK_EXCEPTION(b.add(true), Exception::BuilderKeyMustBeString);
+  b.add("foo");
+  ASSERT_VELOCYPACK_EXCEPTION(b.add("bar", 1), Exception::BuilderKeyAlreadyWritten);
+  b.add(1);
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(1UL, s.length());
+  ASSERT_EQ(1, s.get("foo").getInt());
+
+  b.clear();
+  b.openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(b.add("foo", 1), Exception::BuilderNeedOpenObject);
+}
+
 TEST(BuilderTest, StringChar) {
   char const* value = "der fuxx ging in den wald und aß pilze";
   std::size_t const valueLen = strlen(value);
@@ -2131,6 +2395,47 @@ TEST(BuilderTest, GetKeyCompact) {
   b.close();
 }
 
+TEST(BuilderTest, NestedMembersInterleaved) {
+  // members of all open levels share one offset stack, so add members
+  // before and after each nested level and check nothing gets mixed up
+  int const depth = 200;
+  Builder b;
+  b.openObject();
+  for (int i = 0; i < depth; ++i) {
+    b.add("a", Value(i));
+    b.add("m", Value(ValueType::Array));
+    for (int j = 0; j < i % 7; ++j) {
+      b.add(Value(j));
+    }
+    b.close();
+    b.add("sub", Value(ValueType::Object));
+    ASSERT_FALSE(b.hasKey("a"));
+  }
+  for (int i = depth - 1; i >= 0; --i) {
+    // closes the "sub" of level i
+    b.close();
+    ASSERT_TRUE(b.getKey("sub").isObject());
+    ASSERT_TRUE(b.hasKey("a"));
+    ASSERT_TRUE(b.hasKey("m"));
+    ASSERT_FALSE(b.hasKey("z"));
+    b.add("z", Value(i));
+  }
+  b.close();
+  ASSERT_TRUE(b.isClosed());
+
+  // the innermost "sub" is empty, everything else has 4 members
+  Slice s = b.slice();
+  for (int i = 0; i < depth; ++i) {
+    ASSERT_TRUE(s.isObject());
+    ASSERT_EQ(4UL, s.length());
+    ASSERT_EQ(i, s.get("a").getInt());
+    ASSERT_EQ(static_cast<ValueLength>(i % 7), s.get("m").length());
+    ASSERT_EQ(i, s.get("z").getInt());
+    s = s.get("sub");
+  }
+  ASSERT_TRUE(s.isEmptyObject());
+}
+
 TEST(BuilderTest, IsClosedMixed) {
   Builder b;
   ASSERT_TRUE(b.isClosed());
@@ -3538,6 +3843,232 @@ TEST(BuilderTest, stealSharedSlice) {
 }
 #endif
 
+TEST(BuilderTest, AdaptiveHeadRoom) {
+  Options options;
+  options.paddingBehavior = Options::PaddingBehavior::Adaptive;
+
+  auto build = [](Builder& b) {
+    b.openArray();
+    for (std::size_t i = 0; i < 100; ++i) {
+      b.openObject();
+      b.add("id", Value(i));
+      b.add("name", Value("item" + std::to_string(i)));
+      b.add("tags", Value(ValueType::Array));
+      b.add(Value("a"));
+      b.add(Value("b"));
+      b.close();
+      b.close();
+    }
+    b.close();
+  };
+
+  Builder flexible;
+  build(flexible);
+  Builder adaptive(&options);
+  build(adaptive);
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(adaptive.start(), adaptive.size()));
+  ASSERT_EQ(flexible.slice().toJson(), adaptive.slice().toJson());
+  ASSERT_EQ(99UL, adaptive.slice().at(99).get("id").getUInt());
+  ASSERT_EQ("b", adaptive.slice().at(42).get("tags").at(1).copyString());
+
+  // only the first Objects and Arrays are moved, until the Builder has
+  // learned their head room
+  ASSERT_LT(0UL, flexible.memmoveBytes());
+  ASSERT_EQ(0UL, flexible.memmoveBytesAvoided());
+  ASSERT_LT(adaptive.memmoveBytes() * 10, flexible.memmoveBytes());
+  ASSERT_LT(0UL, adaptive.memmoveBytesAvoided());
+
+  // compact Arrays and Objects are not predicted, and their output stays
+  // the same as with Flexible
+  Options compact;
+  compact.buildUnindexedArrays = true;
+  compact.buildUnindexedObjects = true;
+  Builder compactFlexible(&compact);
+  build(compactFlexible);
+  compact.paddingBehavior = Options::PaddingBehavior::Adaptive;
+  Builder compactAdaptive(&compact);
+  build(compactAdaptive);
+  ASSERT_EQ(compactFlexible.bufferRef().toString(),
+            compactAdaptive.bufferRef().toString());
+  ASSERT_EQ(compactFlexible.memmoveBytes(), compactAdaptive.memmoveBytes());
+}
+
+TEST(BuilderTest, HeadRoomSizeHint) {
+  Builder b;
+  b.openObject(false, 100);
+  b.add("a", Value(1));
+  b.add("b", Value("foo"));
+  b.close();
+  b.openArray(false, 10);
+  b.openArray(true, 10);
+  b.add(Value(1));
+  b.add(Value(2));
+  b.close();
+  b.add(Value("bar"));
+  b.close();
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(b.start(), b.slice().byteSize()));
+  ASSERT_EQ("{\"a\":1,\"b\":\"foo\"}", b.slice().toJson());
+  Slice second(b.start() + b.slice().byteSize());
+  ASSERT_TRUE(validator.validate(second.start(), second.byteSize()));
+  ASSERT_EQ("[[1,2],\"bar\"]", second.toJson());
+  ASSERT_EQ(0UL, b.memmoveBytes());
+  ASSERT_LT(0UL, b.memmoveBytesAvoided());
+
+  // a hint that is too small costs a move. one that is too large pads an
+  // indexed header to the next possible size, but moves the members of a
+  // compact one down
+  std::string const filler(300, 'x');
+  for (ValueLength hint : {ValueLength(1), ValueLength(50000)}) {
+    for (bool unindexed : {false, true}) {
+      Builder o;
+      o.openObject(unindexed, hint);
+      o.add("a", Value(filler));
+      o.add("b", Value(2));
+      o.close();
+      ASSERT_TRUE(validator.validate(o.start(), o.size()));
+      ASSERT_EQ(2UL, o.slice().length());
+      ASSERT_EQ(filler, o.slice().get("a").copyString());
+      ASSERT_EQ(hint == 1 || unindexed, o.memmoveBytes() > 0);
+
+      Builder a;
+      a.openArray(unindexed, hint);
+      a.add(Value(filler));
+      a.add(Value(filler));
+      a.close();
+      ASSERT_TRUE(validator.validate(a.start(), a.size()));
+      ASSERT_EQ(filler, a.slice().at(1).copyString());
+    }
+  }
+
+  // a leading None value cannot follow padding
+  Builder n;
+  n.openArray(false, 1000);
+  n.add(Slice::noneSlice());
+  n.add(Value(1));
+  n.close();
+  ASSERT_TRUE(n.slice().at(0).isNone());
+  ASSERT_EQ(1, n.slice().at(1).getInt());
+}
+
+TEST(BuilderTest, HeadRoomSizeHintCompact) {
+  std::string const filler(300, 'x');
+  auto build = [&filler](Builder& b, ValueLength hint) {
+    if (hint == 0) {
+      b.openArray(true);
+    } else {
+      b.openArray(true, hint);
+    }
+    b.add(Value(filler));
+    b.add(Value(1));
+    b.close();
+  };
+
+  // the byte length of a compact Array is never padded, and the result
+  // does not depend on the hint
+  for (auto behavior : {Options::PaddingBehavior::Flexible,
+                        Options::PaddingBehavior::NoPadding,
+                        Options::PaddingBehavior::UsePadding,
+                        Options::PaddingBehavior::Adaptive}) {
+    Options options;
+    options.paddingBehavior = behavior;
+    Builder expected(&options);
+    build(expected, 0);
+    for (ValueLength hint : {ValueLength(1), ValueLength(300), ValueLength(1000000)}) {
+      Builder b(&options);
+      build(b, hint);
+      ASSERT_EQ(expected.bufferRef().toString(), b.bufferRef().toString());
+    }
+  }
+
+  // a hint of 300 reserves the 2 bytes the byte length needs, so it
+  // avoids the move, and a larger one moves the members down
+  Builder exact;
+  build(exact, 300);
+  ASSERT_EQ(0x13, exact.slice().head());
+  ASSERT_EQ(0UL, exact.memmoveBytes());
+  ASSERT_LT(0UL, exact.memmoveBytesAvoided());
+  Builder larger;
+  build(larger, 1000000);
+  ASSERT_LT(0UL, larger.memmoveBytes());
+  ASSERT_EQ(exact.bufferRef().toString(), larger.bufferRef().toString());
+
+  // same for a compact Object
+  Options options;
+  options.paddingBehavior = Options::PaddingBehavior::Adaptive;
+  Builder o(&options);
+  o.openObject(true, 1000000);
+  o.add("a", Value(filler));
+  o.add("b", Value(1));
+  o.close();
+  ASSERT_EQ(0x14, o.slice().head());
+  ASSERT_EQ(2UL, getVariableValueLength(o.slice().byteSize()));
+  ASSERT_EQ(0, o.start()[2] & 0x80);
+  Validator validator;
+  ASSERT_TRUE(validator.validate(o.start(), o.size()));
+  ASSERT_EQ(filler, o.slice().get("a").copyString());
+  ASSERT_EQ(1UL, o.slice().get("b").getUInt());
+}
+
+TEST(BuilderTest, HeadRoomRandomDocuments) {
+  std::mt19937 rng(42);
+  std::function<void(std::string&, int)> document = [&](std::string& out, int depth) {
+    unsigned const kind = depth > 3 ? rng() % 3 : rng() % 5;
+    if (kind == 0) {
+      out.append(std::to_string(rng() % 100000));
+    } else if (kind == 1) {
+      out.append("\"" + std::string(rng() % 200, 's') + "\"");
+    } else if (kind == 2) {
+      out.append(rng() % 2 ? "null" : "true");
+    } else {
+      bool const object = (kind == 3);
+      std::size_t const n = rng() % (depth == 0 ? 300 : 10);
+      out.push_back(object ? '{' : '[');
+      for (std::size_t i = 0; i < n; ++i) {
+        if (i > 0) {
+          out.push_back(',');
+        }
+        if (object) {
+          out.append("\"k" + std::to_string(i) + "\":");
+        }
+        document(out, depth + 1);
+      }
+      out.push_back(object ? '}' : ']');
+    }
+  };
+
+  Validator validator;
+  for (std::size_t i = 0; i < 100; ++i) {
+    std::string json;
+    document(json, 0);
+    for (bool unindexed : {false, true}) {
+      Options flexible;
+      flexible.buildUnindexedArrays = unindexed;
+      flexible.buildUnindexedObjects = unindexed;
+      std::string const expected = Parser::fromJson(json, &flexible)->slice().toJson();
+      for (auto behavior : {Options::PaddingBehavior::Adaptive,
+                            Options::PaddingBehavior::NoPadding}) {
+        Options options;
+        options.paddingBehavior = behavior;
+        options.buildUnindexedArrays = unindexed;
+        options.buildUnindexedObjects = unindexed;
+        Parser parser(&options);
+        // parse several documents with the same Builder, so that it
+        // learns from its predecessors
+        for (std::size_t j = 0; j < 2; ++j) {
+          parser.parse(json);
+          Builder const& b = parser.builder();
+          ASSERT_TRUE(validator.validate(b.start(), b.size()));
+          ASSERT_EQ(expected, b.slice().toJson());
+        }
+      }
+    }
+  }
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -1707,6 +1707,122 @@ TEST(CollectionTest, MergeNullMeansRemoveRecursive) {
   ASSERT_FALSE(s.hasKey("baz"));
 }
 
+TEST(CollectionTest, MergeSortedSameAsUnsorted) {
+  std::string const l(
+      "{\"a\":1,\"b\":{\"x\":1,\"y\":null},\"c\":null,\"d\":[1],\"f\":{}}");
+  std::string const r(
+      "{\"b\":{\"y\":2,\"z\":3},\"c\":5,\"d\":null,\"e\":null,\"g\":7}");
+
+  Options unsortedOptions;
+  unsortedOptions.buildUnindexedObjects = true;
+
+  for (bool mergeValues : {false, true}) {
+    for (bool nullMeansRemove : {false, true}) {
+      // both sorted
+      std::shared_ptr<Builder> p1 = Parser::fromJson(l);
+      std::shared_ptr<Builder> p2 = Parser::fromJson(r);
+      ASSERT_TRUE(p1->slice().isSorted());
+      ASSERT_TRUE(p2->slice().isSorted());
+      Builder sorted = Collection::merge(p1->slice(), p2->slice(), mergeValues, nullMeansRemove);
+
+      // right side not sorted
+      std::shared_ptr<Builder> p3 = Parser::fromJson(r, &unsortedOptions);
+      ASSERT_FALSE(p3->slice().isSorted());
+      Builder unsorted = Collection::merge(p1->slice(), p3->slice(), mergeValues, nullMeansRemove);
+
+      ASSERT_EQ(unsorted.slice().toJson(), sorted.slice().toJson());
+      ASSERT_TRUE(sorted.slice().isSorted());
+      ASSERT_EQ(5UL + (nullMeansRemove ? 0 : 2), sorted.slice().length());
+      ASSERT_EQ(7UL, sorted.slice().get("g").getUInt());
+      if (mergeValues) {
+        ASSERT_EQ(1UL, sorted.slice().get(std::vector<std::string>({"b", "x"})).getUInt());
+      } else {
+        ASSERT_TRUE(sorted.slice().get(std::vector<std::string>({"b", "x"})).isNone());
+      }
+    }
+  }
+}
+
+TEST(CollectionTest, MergeDuplicateKeys) {
+  std::string const l(
+      "{\"a\":1,\"b\":2,\"b\":2,\"c\":{\"x\":1},\"c\":{\"x\":1},"
+      "\"d\":4,\"d\":4}");
+  std::string const r("{\"b\":5,\"c\":{\"y\":2},\"e\":null,\"e\":6}");
+
+  Options unsortedOptions;
+  unsortedOptions.buildUnindexedObjects = true;
+
+  auto count = [](Slice s, std::string const& key) {
+    std::size_t n = 0;
+    for (auto it : ObjectIterator(s)) {
+      if (it.key.isEqualString(key)) {
+        ++n;
+      }
+    }
+    return n;
+  };
+
+  for (bool mergeValues : {false, true}) {
+    for (bool nullMeansRemove : {false, true}) {
+      std::shared_ptr<Builder> p1 = Parser::fromJson(l);
+      std::shared_ptr<Builder> p2 = Parser::fromJson(r);
+      std::shared_ptr<Builder> p3 = Parser::fromJson(l, &unsortedOptions);
+      ASSERT_TRUE(p1->slice().isSorted());
+      ASSERT_TRUE(p2->slice().isSorted());
+      ASSERT_FALSE(p3->slice().isSorted());
+
+      Builder sorted = Collection::merge(p1->slice(), p2->slice(), mergeValues, nullMeansRemove);
+      Builder unsorted = Collection::merge(p3->slice(), p2->slice(), mergeValues, nullMeansRemove);
+
+      for (Slice s : {sorted.slice(), unsorted.slice()}) {
+        ASSERT_EQ(5UL + (nullMeansRemove ? 0 : 1), s.length());
+        ASSERT_EQ(1UL, count(s, "a"));
+        ASSERT_EQ(1UL, count(s, "b"));
+        ASSERT_EQ(5UL, s.get("b").getUInt());
+        ASSERT_EQ(1UL, count(s, "c"));
+        ASSERT_EQ(2UL, s.get(std::vector<std::string>({"c", "y"})).getUInt());
+        ASSERT_EQ(mergeValues, s.get("c").hasKey("x"));
+        ASSERT_EQ(2UL, count(s, "d"));
+        ASSERT_EQ(nullMeansRemove ? 0UL : 1UL, count(s, "e"));
+      }
+      ASSERT_EQ(unsorted.slice().toJson(), sorted.slice().toJson());
+    }
+  }
+}
+
+TEST(CollectionTest, MergeSortedLarge) {
+  Builder left;
+  left.openObject();
+  Builder right;
+  right.openObject();
+  for (std::size_t i = 0; i < 1000; ++i) {
+    std::string const key = "key" + std::to_string(i);
+    if (i % 2 == 0) {
+      left.add(key, Value(i));
+    }
+    if (i % 3 == 0) {
+      right.add(key, Value(i * 10));
+    }
+  }
+  left.close();
+  right.close();
+
+  Builder b = Collection::merge(left.slice(), right.slice(), false, false);
+  Slice s = b.slice();
+  ASSERT_TRUE(s.isSorted());
+  ASSERT_EQ(667UL, s.length());
+  for (std::size_t i = 0; i < 1000; ++i) {
+    Slice value = s.get("key" + std::to_string(i));
+    if (i % 3 == 0) {
+      ASSERT_EQ(i * 10, value.getUInt());
+    } else if (i % 2 == 0) {
+      ASSERT_EQ(i, value.getUInt());
+    } else {
+      ASSERT_TRUE(value.isNone());
+    }
+  }
+}
+
 TEST(CollectionTest, VisitRecursiveNonCompound) {
   std::string const value("[1,null,true,\"foo\"]");
 
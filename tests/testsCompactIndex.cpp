@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <string>
+
+#include "tests-common.h"
+
+namespace {
+
+// the Builders returned by compact() keep pointing at these
+Options const compactOptions = []() {
+  Options options;
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+  return options;
+}();
+
+std::shared_ptr<Builder> compact(std::string const& json) {
+  return Parser::fromJson(json, &compactOptions);
+}
+
+} // namespace
+
+TEST(CompactIndexTest, Array) {
+  std::string json("[");
+  for (int i = 0; i < 1000; ++i) {
+    json += (i > 0 ? "," : "") + std::string("\"") + std::string(i % 13, 'x') +
+            std::to_string(i) + "\"";
+  }
+  json += "]";
+  auto b = compact(json);
+  Slice s = b->slice();
+  ASSERT_EQ(0x13, s.head());
+
+  CompactIndex index;
+  for (ValueLength i = 0; i < s.length(); ++i) {
+    ASSERT_EQ(s.at(i).start(), index.at(s, i).start());
+  }
+  // backwards as well
+  for (ValueLength i = s.length(); i-- > 0; ) {
+    ASSERT_EQ(s.at(i).start(), index.at(s, i).start());
+  }
+  ASSERT_VELOCYPACK_EXCEPTION(index.at(s, 1000), Exception::IndexOutOfBounds);
+}
+
+TEST(CompactIndexTest, Object) {
+  auto b = compact("{\"c\":[1,2,3],\"a\":{\"x\":1},\"b\":\"foo\",\"d\":null}");
+  Slice s = b->slice();
+  ASSERT_EQ(0x14, s.head());
+
+  CompactIndex index;
+  for (ValueLength i = 0; i < s.length(); ++i) {
+    ASSERT_EQ(s.keyAt(i, false).start(), index.keyAt(s, i, false).start());
+    ASSERT_EQ(s.keyAt(i).copyString(), index.keyAt(s, i).copyString());
+    ASSERT_EQ(s.valueAt(i).start(), index.valueAt(s, i).start());
+  }
+  ASSERT_EQ(s.get("a").start(), index.get(s, "a").start());
+  ASSERT_EQ(s.get("b").start(), index.get(s, std::string("b")).start());
+  ASSERT_EQ(s.get("c").start(), index.get(s, StringRef("c")).start());
+  ASSERT_TRUE(index.get(s, "d").isNull());
+  ASSERT_TRUE(index.get(s, "e").isNone());
+  ASSERT_TRUE(index.get(s, "").isNone());
+
+  ASSERT_VELOCYPACK_EXCEPTION(index.keyAt(s, 4), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(index.valueAt(s, 4), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(index.at(s, 0), Exception::InvalidValueType);
+}
+
+TEST(CompactIndexTest, SwitchContainers) {
+  auto a = compact("[1,2,3]");
+  auto o = compact("{\"a\":1,\"b\":2}");
+  auto indexed = Parser::fromJson("{\"a\":1,\"b\":2,\"c\":[4,5]}");
+
+  CompactIndex index;
+  ASSERT_EQ(2, index.at(a->slice(), 1).getInt());
+  ASSERT_EQ(2, index.get(o->slice(), "b").getInt());
+  ASSERT_EQ(3, index.at(a->slice(), 2).getInt());
+  ASSERT_EQ(1, index.valueAt(o->slice(), 0).getInt());
+
+  // other containers are looked up by Slice
+  ASSERT_EQ(2, index.get(indexed->slice(), "b").getInt());
+  ASSERT_EQ(5, index.at(indexed->slice().get("c"), 1).getInt());
+  ASSERT_EQ("c", index.keyAt(indexed->slice(), 2).copyString());
+  ASSERT_EQ(1, index.get(o->slice(), "a").getInt());
+  ASSERT_VELOCYPACK_EXCEPTION(index.get(a->slice(), "a"), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(index.keyAt(a->slice(), 0), Exception::InvalidValueType);
+}
+
+TEST(CompactIndexTest, Clear) {
+  auto b = compact("{\"a\":1,\"b\":2}");
+  CompactIndex index;
+  ASSERT_EQ(1, index.get(b->slice(), "a").getInt());
+
+  // rebuild another value in the same memory
+  b->clear();
+  b->openObject(true);
+  b->add("b", Value(3));
+  b->add("c", Value(4));
+  b->close();
+  index.clear();
+  ASSERT_TRUE(index.get(b->slice(), "a").isNone());
+  ASSERT_EQ(4, index.get(b->slice(), "c").getInt());
+}
+
+TEST(CompactIndexTest, ReusedBuffer) {
+  Options options;
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+  Parser parser(&options);
+  CompactIndex index;
+
+  parser.parse("[\"" + std::string(200, 'a') + "\",2,3]");
+  ASSERT_EQ(0x13, parser.builder().slice().head());
+  ASSERT_EQ(2, index.at(parser.builder().slice(), 1).getInt());
+
+  // another value in the same buffer is detected by its size and length
+  parser.parse("[1,\"x\",3,4,5]");
+  Slice s = parser.builder().slice();
+  ASSERT_EQ(0x13, s.head());
+  ASSERT_EQ("x", index.at(s, 1).copyString());
+  ASSERT_EQ(4, index.at(s, 3).getInt());
+
+  parser.parse("{\"a\":1,\"bb\":\"x\"}");
+  s = parser.builder().slice();
+  ASSERT_EQ(0x14, s.head());
+  ASSERT_EQ("x", index.get(s, "bb").copyString());
+
+  parser.parse("{\"a\":1,\"b\":2,\"c\":3}");
+  s = parser.builder().slice();
+  ASSERT_TRUE(index.get(s, "bb").isNone());
+  ASSERT_EQ(3, index.get(s, "c").getInt());
+  ASSERT_EQ("b", index.keyAt(s, 1).copyString());
+}
+
+TEST(CompactIndexTest, DuplicateKeys) {
+  Builder b;
+  b.openObject(true);
+  b.add("a", Value(1));
+  b.add("b", Value(2));
+  b.add("a", Value(3));
+  b.close();
+  ASSERT_EQ(0x14, b.slice().head());
+
+  CompactIndex index;
+  ASSERT_EQ(b.slice().get("a").start(), index.get(b.slice(), "a").start());
+  ASSERT_EQ(3, index.valueAt(b.slice(), 2).getInt());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -24,6 +24,7 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <ostream>
 #include <fstream>
 #include <string>
@@ -1054,6 +1055,227 @@ TEST(LookupTest, ValueAtObjectEmpty) {
   ASSERT_VELOCYPACK_EXCEPTION(s.valueAt(1), Exception::IndexOutOfBounds);
 }
 
+TEST(LookupTest, LookupKeysOfDifferentLengths) {
+  std::string const longKey(200, 'a');
+  Options options;
+  for (bool compact : { false, true }) {
+    options.buildUnindexedObjects = compact;
+    Builder b(&options);
+    b.openObject();
+    b.add("a", Value(1));
+    b.add("aa", Value(2));
+    b.add(longKey, Value(3));
+    b.add("b", Value(4));
+    b.add(longKey + "b", Value(5));
+    b.close();
+    Slice s = b.slice();
+
+    ASSERT_EQ(1, s.get("a").getInt());
+    ASSERT_EQ(2, s.get("aa").getInt());
+    ASSERT_EQ(3, s.get(longKey).getInt());
+    ASSERT_EQ(4, s.get("b").getInt());
+    ASSERT_EQ(5, s.get(longKey + "b").getInt());
+    ASSERT_TRUE(s.get("").isNone());
+    ASSERT_TRUE(s.get("ab").isNone());
+    ASSERT_TRUE(s.get("aaa").isNone());
+    ASSERT_TRUE(s.get(longKey + "a").isNone());
+    ASSERT_TRUE(s.get(std::string(199, 'a')).isNone());
+  }
+}
+
+TEST(LookupTest, LookupExternalKey) {
+  // an External has the size of a String with sizeof(void*) characters
+  std::string const name(sizeof(void*), 'x');
+  Builder target;
+  target.add(Value(name));
+
+  Options options;
+  for (bool compact : { false, true }) {
+    options.buildUnindexedObjects = compact;
+    Builder b(&options);
+    b.openObject();
+    b.add("a", Value(1));
+    b.add(name, Value(2));
+    b.close();
+
+    // turn the second key into an External pointing to an equal String.
+    // Externals are never valid keys, so lookups must not follow it
+    uint8_t* key = b.bufferRef().data() + (b.slice().keyAt(1).start() - b.start());
+    void const* external = target.slice().start();
+    key[0] = 0x1d;
+    memcpy(key + 1, &external, sizeof(external));
+    Slice s = b.slice();
+    ASSERT_TRUE(s.keyAt(1, false).isExternal());
+
+    ASSERT_EQ(1, s.get("a").getInt());
+    ASSERT_TRUE(s.get(name).isNone());
+  }
+}
+
+TEST(LookupTest, LookupShortKeyStoredAsLongString) {
+  // Object {"ab":1,"c":2}, with "ab" stored as a long String
+  uint8_t const data[] = { 0x0b, 0x14, 0x02,
+                           0xbf, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 'a', 'b', 0x31,
+                           0x41, 'c', 0x32,
+                           0x03, 0x0f };
+  Slice s(&data[0]);
+  ASSERT_EQ(sizeof(data), s.byteSize());
+
+  ASSERT_EQ(1, s.get("ab").getInt());
+  ASSERT_EQ(2, s.get("c").getInt());
+  ASSERT_TRUE(s.get("a").isNone());
+  ASSERT_TRUE(s.get("b").isNone());
+}
+
+TEST(LookupTest, LookupLargeObject) {
+  // large enough for the prefetching binary search
+  for (int n : { 1023, 1024, 1025, 5000 }) {
+    Builder b;
+    b.openObject();
+    for (int i = 0; i < n; ++i) {
+      b.add("test" + std::to_string(i * 2), Value(i));
+    }
+    b.close();
+    Slice s = b.slice();
+
+    for (int i = 0; i < n; ++i) {
+      ASSERT_EQ(i, s.get("test" + std::to_string(i * 2)).getInt());
+      ASSERT_TRUE(s.get("test" + std::to_string(i * 2 + 1)).isNone());
+    }
+    ASSERT_TRUE(s.get("").isNone());
+    ASSERT_TRUE(s.get("a").isNone());
+    ASSERT_TRUE(s.get("test").isNone());
+    ASSERT_TRUE(s.get("zzz").isNone());
+  }
+}
+
+TEST(LookupTest, GetManySorted) {
+  Builder b;
+  b.openObject();
+  for (int i = 0; i < 500; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+  Slice s = b.slice();
+  ASSERT_EQ(0x0c, s.head());
+
+  std::vector<std::string> names{"key0", "key123", "key17", "key2", "key42",
+                                 "key499", "key7", "key99", "missing"};
+  std::vector<StringRef> attributes(names.begin(), names.end());
+  std::vector<Slice> values(attributes.size());
+  ASSERT_EQ(8U, s.get(attributes.data(), attributes.size(), values.data()));
+
+  for (std::size_t i = 0; i < attributes.size(); ++i) {
+    ASSERT_EQ(s.get(attributes[i]).start(), values[i].start());
+  }
+  ASSERT_TRUE(values.back().isNone());
+}
+
+TEST(LookupTest, GetManyAgainstGet) {
+  Builder b;
+  b.openObject();
+  for (int i = 0; i < 100; ++i) {
+    b.add(std::string(i % 7, 'x') + std::to_string(i * 3), Value(i));
+  }
+  b.close();
+  Slice s = b.slice();
+
+  std::vector<std::string> names;
+  for (int i = 0; i < 300; i += 2) {
+    names.push_back(std::string(i % 7, 'x') + std::to_string(i));
+  }
+  std::sort(names.begin(), names.end(), [](std::string const& lhs, std::string const& rhs) {
+    return StringRef(lhs).compare(StringRef(rhs)) < 0;
+  });
+
+  // every prefix and every stride of the sorted names
+  for (std::size_t stride = 1; stride < 40; stride += 3) {
+    std::vector<StringRef> attributes;
+    for (std::size_t i = 0; i < names.size(); i += stride) {
+      attributes.emplace_back(names[i]);
+    }
+    std::vector<Slice> values(attributes.size());
+    ValueLength found = s.get(attributes.data(), attributes.size(), values.data());
+
+    ValueLength expected = 0;
+    for (std::size_t i = 0; i < attributes.size(); ++i) {
+      Slice value = s.get(attributes[i]);
+      ASSERT_EQ(value.start(), values[i].start());
+      expected += value.isNone() ? 0 : 1;
+    }
+    ASSERT_EQ(expected, found);
+  }
+}
+
+TEST(LookupTest, GetManySmallAndCompact) {
+  Options options;
+  for (bool compact : { false, true }) {
+    options.buildUnindexedObjects = compact;
+    for (std::string const& json : { std::string("{\"b\":1}"),
+                                     std::string("{\"c\":3,\"a\":1,\"b\":2}"),
+                                     std::string("{\"e\":5,\"d\":4,\"c\":3,\"a\":1,\"b\":2}") }) {
+      Parser parser(&options);
+      parser.parse(json);
+      Slice s = parser.builder().slice();
+      ASSERT_TRUE(!compact || s.head() == 0x14);
+
+      StringRef attributes[] = { StringRef("a"), StringRef("b"), StringRef("bb"), StringRef("e") };
+      Slice values[4];
+      ValueLength found = s.get(attributes, 4, values);
+
+      ValueLength expected = 0;
+      for (std::size_t i = 0; i < 4; ++i) {
+        Slice value = s.get(attributes[i]);
+        ASSERT_EQ(value.start(), values[i].start());
+        expected += value.isNone() ? 0 : 1;
+      }
+      ASSERT_EQ(expected, found);
+    }
+  }
+}
+
+TEST(LookupTest, GetManyDuplicates) {
+  Parser parser;
+  parser.parse("{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5}");
+  Slice s = parser.builder().slice();
+
+  StringRef attributes[] = { StringRef("b"), StringRef("b"), StringRef("x"), StringRef("x") };
+  Slice values[4];
+  ASSERT_EQ(2U, s.get(attributes, 4, values));
+  ASSERT_EQ(2, values[0].getInt());
+  ASSERT_EQ(2, values[1].getInt());
+  ASSERT_TRUE(values[2].isNone());
+  ASSERT_TRUE(values[3].isNone());
+}
+
+TEST(LookupTest, GetManyEmpty) {
+  Parser parser;
+  parser.parse("{}");
+  Slice s = parser.builder().slice();
+
+  StringRef attributes[] = { StringRef("a") };
+  Slice values[1] = { Slice::nullSlice() };
+  ASSERT_EQ(0U, s.get(attributes, 1, values));
+  ASSERT_TRUE(values[0].isNone());
+
+  parser.parse("{\"a\":1}");
+  ASSERT_EQ(0U, parser.builder().slice().get(attributes, 0, values));
+}
+
+TEST(LookupTest, GetManyInvalid) {
+  StringRef attributes[] = { StringRef("b"), StringRef("a") };
+  Slice values[2];
+
+  Parser parser;
+  parser.parse("{\"a\":1,\"b\":2}");
+  ASSERT_VELOCYPACK_EXCEPTION(parser.builder().slice().get(attributes, 2, values),
+                              Exception::InvalidAttributePath);
+
+  parser.parse("[1,2]");
+  ASSERT_VELOCYPACK_EXCEPTION(parser.builder().slice().get(attributes, 1, values),
+                              Exception::InvalidValueType);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <string>
+
+#include "tests-common.h"
+
+namespace {
+
+// heap-backed resource that keeps track of what is in use
+class CountingResource final : public MemoryResource {
+ public:
+  CountingResource() : allocations(0), liveBytes(0) {}
+
+  void* allocate(std::size_t size, std::size_t) override {
+    ++allocations;
+    liveBytes += size;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  void deallocate(void* p, std::size_t size, std::size_t) noexcept override {
+    liveBytes -= size;
+    free(p);
+  }
+
+  std::size_t allocations;
+  std::size_t liveBytes;
+};
+
+bool isAligned(void* p, std::size_t alignment) {
+  return (reinterpret_cast<uintptr_t>(p) % alignment) == 0;
+}
+
+} // namespace
+
+TEST(MemoryResourceTest, ArenaAllocate) {
+  ArenaMemoryResource arena(256);
+  ASSERT_EQ(0U, arena.blocks());
+  ASSERT_EQ(0U, arena.allocatedBytes());
+
+  void* a = arena.allocate(3, 1);
+  void* b = arena.allocate(8, 8);
+  void* c = arena.allocate(16, 16);
+  ASSERT_NE(a, b);
+  ASSERT_NE(b, c);
+  ASSERT_TRUE(isAligned(b, 8));
+  ASSERT_TRUE(isAligned(c, 16));
+  ASSERT_EQ(1U, arena.blocks());
+  ASSERT_EQ(27U, arena.allocatedBytes());
+
+  // larger than the block size
+  void* d = arena.allocate(10000, 8);
+  memset(d, 0x42, 10000);
+  ASSERT_EQ(2U, arena.blocks());
+  ASSERT_EQ(10027U, arena.allocatedBytes());
+}
+
+TEST(MemoryResourceTest, ArenaReallocate) {
+  ArenaMemoryResource arena(1024);
+
+  uint8_t* a = static_cast<uint8_t*>(arena.allocate(10, 1));
+  memcpy(a, "0123456789", 10);
+  // the most recent allocation grows in place
+  ASSERT_EQ(a, arena.reallocate(a, 10, 100, 1));
+  ASSERT_EQ(100U, arena.allocatedBytes());
+
+  uint8_t* b = static_cast<uint8_t*>(arena.allocate(10, 1));
+  ASSERT_EQ(a + 100, b);
+
+  // not the most recent allocation anymore: must move
+  uint8_t* c = static_cast<uint8_t*>(arena.reallocate(a, 100, 200, 1));
+  ASSERT_NE(a, c);
+  ASSERT_EQ(0, memcmp(c, "0123456789", 10));
+
+  // does not fit into the current block anymore: must move
+  uint8_t* d = static_cast<uint8_t*>(arena.reallocate(c, 200, 5000, 1));
+  ASSERT_NE(c, d);
+  ASSERT_EQ(0, memcmp(d, "0123456789", 10));
+  ASSERT_EQ(2U, arena.blocks());
+}
+
+TEST(MemoryResourceTest, ArenaInitialBuffer) {
+  alignas(16) uint8_t buffer[512];
+  ArenaMemoryResource arena(buffer, sizeof(buffer));
+
+  void* a = arena.allocate(100, 8);
+  ASSERT_EQ(static_cast<void*>(&buffer[0]), a);
+  ASSERT_EQ(0U, arena.blocks());
+
+  arena.allocate(1000, 8);
+  ASSERT_EQ(1U, arena.blocks());
+
+  arena.release();
+  ASSERT_EQ(0U, arena.allocatedBytes());
+  ASSERT_EQ(1U, arena.blocks());
+}
+
+TEST(MemoryResourceTest, ArenaRelease) {
+  ArenaMemoryResource arena(128);
+
+  for (std::size_t i = 0; i < 100; ++i) {
+    arena.allocate(100, 8);
+  }
+  ASSERT_LT(1U, arena.blocks());
+  ASSERT_EQ(10000U, arena.allocatedBytes());
+
+  arena.release();
+  ASSERT_EQ(1U, arena.blocks());
+  ASSERT_EQ(0U, arena.allocatedBytes());
+
+  // the retained block is the largest one, so the next round of
+  // smaller allocations does not need new blocks
+  for (std::size_t i = 0; i < 10; ++i) {
+    arena.allocate(100, 8);
+  }
+  ASSERT_EQ(1U, arena.blocks());
+}
+
+TEST(MemoryResourceTest, ResourceAllocator) {
+  CountingResource resource;
+  {
+    std::vector<uint64_t, ResourceAllocator<uint64_t>> values{
+        ResourceAllocator<uint64_t>(&resource)};
+    for (uint64_t i = 0; i < 1000; ++i) {
+      values.push_back(i);
+    }
+    ASSERT_LT(0U, resource.allocations);
+    ASSERT_LE(1000 * sizeof(uint64_t), resource.liveBytes);
+
+    // copies use the default heap
+    std::vector<uint64_t, ResourceAllocator<uint64_t>> copy(values);
+    ASSERT_EQ(nullptr, copy.get_allocator().resource());
+    ASSERT_EQ(values, copy);
+
+    // moves keep the resource
+    std::vector<uint64_t, ResourceAllocator<uint64_t>> moved(std::move(values));
+    ASSERT_EQ(&resource, moved.get_allocator().resource());
+  }
+  ASSERT_EQ(0U, resource.liveBytes);
+}
+
+TEST(MemoryResourceTest, BufferWithResource) {
+  CountingResource resource;
+  {
+    Buffer<uint8_t> buffer(&resource);
+    ASSERT_EQ(&resource, buffer.resource());
+    ASSERT_TRUE(buffer.usesLocalMemory());
+    ASSERT_EQ(0U, resource.allocations);
+
+    std::string value(10000, 'x');
+    buffer.append(value);
+    ASSERT_FALSE(buffer.usesLocalMemory());
+    ASSERT_LT(0U, resource.allocations);
+    ASSERT_EQ(buffer.capacity(), resource.liveBytes);
+    for (int i = 0; i < 10; ++i) {
+      buffer.append(value);
+    }
+    ASSERT_EQ(buffer.capacity(), resource.liveBytes);
+    ASSERT_EQ(11 * value.size(), buffer.size());
+
+    Buffer<uint8_t> copy(buffer);
+    ASSERT_EQ(nullptr, copy.resource());
+    ASSERT_EQ(buffer.toString(), copy.toString());
+
+    Buffer<uint8_t> moved(std::move(buffer));
+    ASSERT_EQ(&resource, moved.resource());
+    ASSERT_EQ(copy.toString(), moved.toString());
+
+    moved.clear();
+    ASSERT_EQ(0U, resource.liveBytes);
+    moved.append(value);
+    ASSERT_EQ(moved.capacity(), resource.liveBytes);
+  }
+  ASSERT_EQ(0U, resource.liveBytes);
+}
+
+TEST(MemoryResourceTest, BufferWithArena) {
+  ArenaMemoryResource arena;
+  Buffer<uint8_t> buffer(&arena);
+  for (int i = 0; i < 10000; ++i) {
+    buffer.push_back('a' + (i % 26));
+  }
+  ASSERT_EQ(10000U, buffer.size());
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_EQ('a' + (i % 26), buffer[i]);
+  }
+  ASSERT_LT(0U, arena.blocks());
+}
+
+TEST(MemoryResourceTest, BufferStealWithResource) {
+  ArenaMemoryResource arena;
+  Buffer<uint8_t> buffer(&arena);
+  std::string value(10000, 'x');
+  buffer.append(value);
+  ASSERT_FALSE(buffer.usesLocalMemory());
+
+  ASSERT_VELOCYPACK_EXCEPTION(buffer.stealChecked(), Exception::InternalError);
+  ASSERT_EQ(value, buffer.toString());
+
+#if __cplusplus >= 201703L
+  // a SharedSlice must copy the memory instead of stealing it
+  buffer.clear();
+  Builder b(buffer);
+  b.add(Value(value));
+  SharedSlice shared(std::move(buffer));
+  ASSERT_EQ(value, shared.slice().copyString());
+#endif
+}
+
+TEST(MemoryResourceTest, BuilderWithResource) {
+  CountingResource resource;
+  std::string expected;
+  {
+    Builder b(resource);
+    ASSERT_EQ(&resource, b.buffer()->resource());
+    b.openObject();
+    for (int i = 0; i < 100; ++i) {
+      std::string key = "key" + std::to_string(i);
+      b.add(key, Value(ValueType::Array));
+      for (int j = 0; j < i; ++j) {
+        b.add(Value(j));
+      }
+      b.close();
+    }
+    b.close();
+
+    std::size_t const allocations = resource.allocations;
+    ASSERT_LT(0U, allocations);
+
+    Builder ref;
+    ref.add(b.slice());
+    ASSERT_TRUE(ref.slice().binaryEquals(b.slice()));
+    expected = b.toJson();
+
+    // a copy does not use the resource
+    Builder copy(b);
+    ASSERT_EQ(nullptr, copy.buffer()->resource());
+    ASSERT_EQ(allocations, resource.allocations);
+    ASSERT_EQ(expected, copy.toJson());
+  }
+  ASSERT_EQ(0U, resource.liveBytes);
+  ASSERT_EQ(std::string::npos, expected.find("null"));
+}
+
+TEST(MemoryResourceTest, BuilderParseWithArena) {
+  std::string const value(
+      "{\"name\":\"test\",\"values\":[1,2,3,4,5,6,7,8,9,10],"
+      "\"nested\":{\"a\":{\"b\":{\"c\":[true,false,null]}}},"
+      "\"text\":\"" + std::string(1000, 'x') + "\"}");
+
+  ArenaMemoryResource arena;
+  std::string first;
+  for (int i = 0; i < 10; ++i) {
+    {
+      Builder b(arena);
+      Parser parser(b);
+      parser.parse(value);
+      ASSERT_EQ(value.size(), b.toJson().size());
+      if (i == 0) {
+        first = b.toJson();
+        ASSERT_LT(0U, arena.allocatedBytes());
+      } else {
+        ASSERT_EQ(first, b.toJson());
+      }
+    }
+    arena.release();
+    ASSERT_EQ(1U, arena.blocks());
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -24,7 +24,9 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
 #include <ostream>
+#include <random>
 #include <string>
 
 #include "tests-common.h"
@@ -731,6 +733,126 @@ TEST(ParserTest, DoublePlusInf) {
   ASSERT_VELOCYPACK_EXCEPTION(parser.parse(value), Exception::NumberOutOfRange);
 }
 
+static void checkDoubleLikeStrtod(std::string const& value) {
+  double expected = strtod(value.c_str(), nullptr);
+
+  Parser parser;
+  ValueLength len = parser.parse(value);
+  ASSERT_EQ(1ULL, len);
+
+  std::shared_ptr<Builder> builder = parser.steal();
+  Slice s(builder->start());
+  ASSERT_TRUE(s.isDouble()) << value;
+  double actual = s.getDouble();
+  // compare bitwise, so that the sign of zero matters as well
+  uint64_t expectedBits, actualBits;
+  memcpy(&expectedBits, &expected, sizeof(double));
+  memcpy(&actualBits, &actual, sizeof(double));
+  ASSERT_EQ(expectedBits, actualBits) << value;
+}
+
+TEST(ParserTest, DoubleExactRounding) {
+  std::vector<std::string> const values{
+      "0.0", "-0.0", "0e999999", "-0e-999999", "1.0", "0.1", "0.2", "0.3",
+      "1e22", "1e23", "9007199254740993.0", "9007199254740992.5",
+      "9007199254740993.0000000000000000001", "2.2250738585072011e-308",
+      "2.2250738585072012e-308", "2.2250738585072014e-308",
+      "4.9406564584124654e-324", "2.4703282292062327e-324",
+      "2.4703282292062328e-324", "1e-400", "1.7976931348623157e308",
+      "1.7976931348623158e308", "18446744073709551616.0",
+      "18446744073709551615.5", "-184467440737095516161.123",
+      "3.141592653589793238462643383279502884197169399375105820974944",
+      "0.000000000000000000000000000000000000000000000000001234",
+      "7.038531e-26", "8.988465674311579e+307", "1.00000000000000011102230246251565404236316680908203125",
+      "1.00000000000000011102230246251565404236316680908203124",
+      "1.00000000000000011102230246251565404236316680908203126",
+      "123456789012345678901234567890e-20", "1.5e-307", "5e-324", "1e-323",
+      "4.35679716185616e-310", "12345678901234567890.123e-5",
+      "0.1e308", "10000000000000000000000000000000000000000e-350"};
+  for (auto const& value : values) {
+    checkDoubleLikeStrtod(value);
+  }
+}
+
+TEST(ParserTest, DoubleRandomLikeStrtod) {
+  std::mt19937_64 rng(42);
+  char buffer[64];
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t bits = rng();
+    double d;
+    memcpy(&d, &bits, sizeof(double));
+    if (!std::isfinite(d)) {
+      continue;
+    }
+    // vary the number of printed digits to produce both shortest and
+    // truncated representations
+    snprintf(buffer, sizeof(buffer), "%.*e", static_cast<int>(i % 25), d);
+    if (std::isfinite(strtod(buffer, nullptr))) {
+      // rounding the last printed digit up may exceed the range
+      checkDoubleLikeStrtod(buffer);
+    }
+    // plain decimals with a fraction, not using scientific notation
+    snprintf(buffer, sizeof(buffer), "%llu.%llu",
+             static_cast<unsigned long long>(rng() >> (rng() % 64)),
+             static_cast<unsigned long long>(rng() >> (rng() % 64)));
+    checkDoubleLikeStrtod(buffer);
+  }
+}
+
+TEST(ParserTest, DoubleLongMantissa) {
+  // more significant digits than fit into 64 bits
+  std::string value("0.");
+  for (int i = 0; i < 800; ++i) {
+    value.push_back('0' + (i * 7) % 10);
+    checkDoubleLikeStrtod(value);
+    checkDoubleLikeStrtod(value + "e-300");
+    checkDoubleLikeStrtod(value + "e+300");
+  }
+}
+
+TEST(ParserTest, IntDigitLengths) {
+  // all lengths around the 8-digit blocks, with different terminators
+  uint64_t value = 0;
+  for (int digits = 1; digits <= 19; ++digits) {
+    value = value * 10 + (digits % 10);
+    std::string const text = std::to_string(value);
+    for (char const* json : {"[%s]", "[%s ]", "[%s,1]", "[%s\n]", "%s"}) {
+      char buffer[64];
+      snprintf(buffer, sizeof(buffer), json, text.c_str());
+      std::shared_ptr<Builder> b = Parser::fromJson(std::string(buffer));
+      Slice s = b->slice();
+      ASSERT_EQ(value, (s.isArray() ? s.at(0) : s).getUInt()) << buffer;
+    }
+  }
+}
+
+TEST(ParserTest, IntOverflowBoundaries) {
+  std::vector<std::string> const values{
+      "18446744073709551615", "18446744073709551614", "18446744073600000000",
+      "18446744073699999999", "99999999999999999999", "18446744073709551616",
+      "184467440737095516150", "12345678901234567890123456789"};
+  for (auto const& value : values) {
+    std::shared_ptr<Builder> b = Parser::fromJson(value);
+    Slice s = b->slice();
+    if (s.isUInt()) {
+      ASSERT_EQ(value, std::to_string(s.getUInt()));
+    } else {
+      ASSERT_TRUE(s.isDouble()) << value;
+      ASSERT_EQ(strtod(value.c_str(), nullptr), s.getDouble()) << value;
+    }
+  }
+}
+
+TEST(ParserTest, DoubleDigitBlocks) {
+  std::string digits;
+  for (int i = 0; i < 40; ++i) {
+    digits.push_back('1' + (i * 3) % 9);
+    checkDoubleLikeStrtod("0." + digits);
+    checkDoubleLikeStrtod(digits.substr(0, 1) + "." + digits + "e-5");
+    checkDoubleLikeStrtod("-" + digits + ".12345678");
+  }
+}
+
 TEST(ParserTest, Empty) {
   std::string const value("");
 
@@ -2534,6 +2656,456 @@ TEST(ParserTest, UseBuilderOnStackOptionsNullPtr) {
   delete parser;
 }
 
+// feeds the value in chunks of the given size and compares the result
+// with the one of a regular parse
+static void checkFeedParse(std::string const& value, std::size_t chunkSize,
+                           Options const* options = &Options::Defaults) {
+  Parser expected(options);
+  expected.parse(value);
+
+  Parser parser(options);
+  for (std::size_t i = 0; i < value.size(); i += chunkSize) {
+    // use a separate copy of each chunk, so that the parser cannot
+    // rely on previous chunks staying valid
+    std::string chunk = value.substr(i, chunkSize);
+    parser.feed(chunk);
+  }
+  ASSERT_EQ(1ULL, parser.finish());
+
+  // compare the raw buffers, as the top-level value may still be open
+  Buffer<uint8_t> const& a = expected.builder().bufferRef();
+  Buffer<uint8_t> const& b = parser.builder().bufferRef();
+  ASSERT_EQ(a.size(), b.size()) << value;
+  ASSERT_EQ(0, memcmp(a.data(), b.data(), a.size())) << value;
+}
+
+static void checkFeedParseError(std::string const& value,
+                                std::size_t chunkSize) {
+  Parser parser;
+  try {
+    for (std::size_t i = 0; i < value.size(); i += chunkSize) {
+      parser.feed(value.substr(i, chunkSize));
+    }
+    parser.finish();
+    ASSERT_TRUE(false) << "no exception for: " << value;
+  } catch (Exception const& ex) {
+    ASSERT_EQ(Exception::ParseError, ex.errorCode()) << value;
+  }
+}
+
+TEST(ParserTest, FeedAllSplitPoints) {
+  std::vector<std::string> const values{
+      "null", "true", "false", "0", "-12.5e+3", "  1234567  ", "\"\"",
+      "\"abc\\\"def\\\\\"", "\"\\\\\\\\\\\"\"", "\"\\u00e4\\ud83d\\ude00\"",
+      "[]", "{}", "[1,2,[3,[4,{}]],\"x\"]",
+      "{\"a\":1,\"b\":{\"c\":[true,false,null]},\"d\":\"\\\\\"}",
+      " [ 1 , -0.5e-3 , \"foo bar\" , { \"k\" : \"v\" } ] ",
+      "[12345678901234567890123,1e-400000000,-0]"};
+
+  for (auto const& value : values) {
+    for (std::size_t chunkSize = 1; chunkSize <= value.size(); ++chunkSize) {
+      checkFeedParse(value, chunkSize);
+    }
+  }
+
+  // a byte order mark is skipped if the first chunk contains it
+  std::string const bom("\xef\xbb\xbf{\"bom\":true}");
+  for (std::size_t chunkSize = 3; chunkSize <= bom.size(); ++chunkSize) {
+    checkFeedParse(bom, chunkSize);
+  }
+}
+
+TEST(ParserTest, FeedLargeChunks) {
+  std::string value("[");
+  for (int i = 0; i < 2000; ++i) {
+    if (i > 0) {
+      value.push_back(',');
+    }
+    value.append("{\"id\":" + std::to_string(i) + ",\"name\":\"");
+    value.append(std::string(i % 300, 'a'));
+    if (i % 3 == 0) {
+      value.append("\\\"\\\\");
+    }
+    value.append("\",\"list\":[1.5,-2,true,null]}");
+  }
+  value.append("]");
+
+  for (std::size_t chunkSize : {7, 100, 4096, 65536}) {
+    checkFeedParse(value, chunkSize);
+  }
+}
+
+TEST(ParserTest, FeedOptions) {
+  Options options;
+  options.keepTopLevelOpen = true;
+  checkFeedParse("{\"a\":1,\"b\":2}", 3, &options);
+  checkFeedParse("{}", 1, &options);
+
+  options.keepTopLevelOpen = false;
+  options.validateUtf8Strings = true;
+  checkFeedParse("[\"\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80\"]", 1, &options);
+
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+  AttributeTranslatorScope scope(translator.get());
+  options.validateUtf8Strings = false;
+  options.attributeTranslator = translator.get();
+  checkFeedParse("{\"foo\":1,\"bar\":{\"foo\":2},\"baz\":3}", 2, &options);
+}
+
+TEST(ParserTest, FeedInvalid) {
+  std::vector<std::string> const values{
+      "", "  ", "[", "[1", "[1,", "{", "{\"a\"", "{\"a\":", "{\"a\":1",
+      "{\"a\":1,", "\"abc", "\"abc\\\"", "tru", "nul", "fals", "trux",
+      "[1]]", "1 2", "[1,]", "{,}", "{\"a\" 1}", "{1:2}", "[1 2]",
+      "-", "1.", "1e", "01", "12-3", "[\"a\"\"b\"]"};
+
+  for (auto const& value : values) {
+    for (std::size_t chunkSize = 1; chunkSize <= value.size() + 1;
+         ++chunkSize) {
+      checkFeedParseError(value, chunkSize);
+    }
+  }
+}
+
+TEST(ParserTest, FeedReuseAfterError) {
+  Parser parser;
+  parser.feed("[1,");
+  ASSERT_VELOCYPACK_EXCEPTION(parser.feed("}"), Exception::ParseError);
+
+  parser.feed("[1,");
+  parser.feed("2]");
+  ASSERT_EQ(1ULL, parser.finish());
+
+  Slice s(parser.start());
+  ASSERT_TRUE(s.isArray());
+  ASSERT_EQ(2ULL, s.length());
+  ASSERT_EQ(2, s.at(1).getInt());
+}
+
+TEST(ParserTest, FeedErrorIntoOpenArray) {
+  Builder builder;
+  builder.openArray();
+  builder.add(Value(1));
+  Options options;
+  options.clearBuilderBeforeParse = false;
+  Parser parser(builder, &options);
+
+  parser.feed("tr");
+  ASSERT_VELOCYPACK_EXCEPTION(parser.feed("x "), Exception::ParseError);
+  parser.feed("nul");
+  ASSERT_VELOCYPACK_EXCEPTION(parser.finish(), Exception::ParseError);
+
+  // the failed values are not members of the Array
+  builder.close();
+  Slice s(builder.slice());
+  ASSERT_EQ(1ULL, s.length());
+  ASSERT_EQ(1, s.at(0).getInt());
+}
+
+static std::string parseProjected(std::string const& value,
+                                  Projection const& projection,
+                                  Options options = Options()) {
+  options.projection = &projection;
+  Parser parser(&options);
+  parser.parse(value);
+  Slice s(parser.start());
+  EXPECT_TRUE(s.isObject());
+  return s.toJson();
+}
+
+TEST(ParserTest, ProjectionTopLevel) {
+  std::string const value(
+      "{\"a\":1,\"b\":\"foo\",\"c\":[1,2,{\"x\":\"y\"}],\"d\":{\"e\":true},"
+      "\"f\":null}");
+
+  ASSERT_EQ("{\"a\":1}", parseProjected(value, {"a"}));
+  ASSERT_EQ("{\"b\":\"foo\",\"c\":[1,2,{\"x\":\"y\"}]}",
+            parseProjected(value, {"c", "b"}));
+  ASSERT_EQ("{\"d\":{\"e\":true},\"f\":null}", parseProjected(value, {"d", "f"}));
+  ASSERT_EQ("{}", parseProjected(value, {"z"}));
+  ASSERT_EQ("{}", parseProjected("{}", {"a"}));
+}
+
+TEST(ParserTest, ProjectionNested) {
+  std::string const value(
+      "{\"user\":{\"id\":42,\"name\":\"x\",\"address\":{\"city\":\"K\","
+      "\"zip\":\"5\"}},\"ts\":12345,\"tags\":[\"a\",\"b\"],\"other\":{\"id\":1}}");
+
+  ASSERT_EQ("{\"tags\":[\"a\",\"b\"],\"ts\":12345,\"user\":{\"id\":42}}",
+            parseProjected(value, {"user.id", "ts", "tags"}));
+  ASSERT_EQ("{\"user\":{\"address\":{\"zip\":\"5\"},\"id\":42}}",
+            parseProjected(value, {"user.address.zip", "user.id"}));
+  // the same attribute name below different parents
+  ASSERT_EQ("{\"other\":{\"id\":1},\"user\":{\"id\":42}}",
+            parseProjected(value, {"user.id", "other.id"}));
+  // a complete value and one of its sub paths
+  ASSERT_EQ("{\"user\":{\"address\":{\"city\":\"K\",\"zip\":\"5\"},\"id\":42,"
+            "\"name\":\"x\"}}",
+            parseProjected(value, {"user.id", "user"}));
+  // nested objects without selected members are left out
+  ASSERT_EQ("{\"ts\":12345}", parseProjected(value, {"user.missing", "ts"}));
+  // paths leading through non-Objects do not match
+  ASSERT_EQ("{}", parseProjected(value, {"tags.a", "ts.x"}));
+}
+
+TEST(ParserTest, ProjectionEscapedKeys) {
+  std::string const value(
+      "{\"a\\\"b\":1,\"c\\u0064\":{\"e\":2},\"\\\\\":3,\"skip\\n\":4}");
+
+  ASSERT_EQ("{\"a\\\"b\":1,\"cd\":{\"e\":2}}",
+            parseProjected(value, Projection({"a\"b", "cd.e"})));
+  ASSERT_EQ("{\"\\\\\":3}", parseProjected(value, {"\\"}));
+}
+
+TEST(ParserTest, ProjectionNonObject) {
+  ASSERT_EQ("{}", parseProjected("[1,2,3]", {"a"}));
+  ASSERT_EQ("{}", parseProjected("\"abc\"", {"a"}));
+  ASSERT_EQ("{}", parseProjected("  12.5e3 ", {"a"}));
+}
+
+TEST(ParserTest, ProjectionPathComponents) {
+  Projection projection;
+  ASSERT_TRUE(projection.empty());
+  projection.add(std::vector<std::string>{"a.b", "c"});
+  ASSERT_FALSE(projection.empty());
+
+  ASSERT_EQ("{\"a.b\":{\"c\":1}}",
+            parseProjected("{\"a\":{\"b\":{\"c\":2}},\"a.b\":{\"c\":1,\"d\":2}}",
+                           projection));
+  ASSERT_VELOCYPACK_EXCEPTION(projection.add(std::vector<std::string>()),
+                              Exception::InvalidAttributePath);
+}
+
+TEST(ParserTest, ProjectionLargeValues) {
+  // long strings exercise the SIMD string skipping
+  std::string value("{");
+  for (int i = 0; i < 100; ++i) {
+    value.append("\"skip" + std::to_string(i) + "\":\"" +
+                 std::string(i * 7, 'x') + (i % 3 == 0 ? "\\\"\\\\\"," : "\","));
+    value.append("\"n" + std::to_string(i) + "\":[" + std::to_string(i) +
+                 ",-1.5e-3,true,false,null,{\"a\":[]}],");
+  }
+  value.append("\"keep\":\"" + std::string(300, 'y') + "\"}");
+
+  ASSERT_EQ("{\"keep\":\"" + std::string(300, 'y') + "\",\"n99\":[99,-0.0015,"
+            "true,false,null,{\"a\":[]}]}",
+            parseProjected(value, {"keep", "n99"}));
+}
+
+TEST(ParserTest, ProjectionInvalid) {
+  Projection projection({"a"});
+  Options options;
+  options.projection = &projection;
+
+  std::vector<std::string> const values{
+      "{\"b\":tru}", "{\"b\":[1,}", "{\"b\":{\"c\" 1}}", "{\"b\":\"abc}",
+      "{\"b\":\"\\x\"}", "{\"b\":\"\\u12g4\"}", "{\"b\":01}", "{\"b\":1.}",
+      "{\"b\":1e}", "{\"b\":-}", "{\"b\":{}", "{\"b\":1 \"a\":2}",
+      "{\"a\":1,}", "[1,2"};
+
+  for (auto const& value : values) {
+    Parser parser(&options);
+    ASSERT_VELOCYPACK_EXCEPTION(parser.parse(value), Exception::ParseError);
+  }
+
+  Parser parser(&options);
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse(std::string("{\"b\":\"\x01\"}")),
+                              Exception::UnexpectedControlCharacter);
+
+  options.validateUtf8Strings = true;
+  Parser utf8Parser(&options);
+  ASSERT_VELOCYPACK_EXCEPTION(utf8Parser.parse(std::string("{\"b\":\"\xff\"}")),
+                              Exception::InvalidUtf8Sequence);
+
+  ASSERT_VELOCYPACK_EXCEPTION(parser.feed("{}"), Exception::NotImplemented);
+}
+
+TEST(ParserTest, ProjectionOptions) {
+  Projection projection({"a", "b.c"});
+  Options options;
+  options.projection = &projection;
+  options.validateUtf8Strings = true;
+
+  std::string const value(
+      "  {\"x\" : \"\xc3\xa4\", \"a\" : [ 1 , 2 ] , \"b\" : { \"c\" : "
+      "\"\xe2\x82\xac\" , \"d\" : 1 } }  ");
+  ASSERT_EQ("{\"a\":[1,2],\"b\":{\"c\":\"\xe2\x82\xac\"}}",
+            parseProjected(value, projection, options));
+}
+
+TEST(ParserTest, InSituStrings) {
+  std::string const text(300, 'x');
+  std::string const value("{\"description\":\"" + text + "\",\"escaped\":\"" +
+                          text + "\\n\",\"name\":\"short\"}");
+  std::string input(value);
+
+  Parser parser;
+  ASSERT_EQ(1ULL, parser.parseInSitu(&input[0], input.size()));
+  Slice s = parser.builder().slice();
+
+  ASSERT_TRUE(s.get("name").isString());
+  ASSERT_TRUE(s.get("description").isExternal());
+  ASSERT_TRUE(s.get("escaped").isString());
+
+  Slice description = s.get("description");
+  ASSERT_TRUE(description.resolveExternal().isString());
+  ASSERT_EQ(text, description.copyString());
+  ASSERT_EQ(text.size(), description.getStringLength());
+  ASSERT_EQ(text, description.stringRef().toString());
+  ValueLength length;
+  char const* p = description.getString(length);
+  ASSERT_EQ(text.size(), length);
+  // the string is not copied
+  ASSERT_TRUE(p >= input.data() && p < input.data() + input.size());
+  ASSERT_TRUE(description.isEqualString(text));
+  ASSERT_EQ(text + "\n", s.get("escaped").copyString());
+
+  ASSERT_EQ(value, s.toJson());
+}
+
+TEST(ParserTest, InSituStringsTransparent) {
+  std::string const text(300, 'z');
+  std::string const value("{\"kkkkkkkkkkkk\":\"" + text + "\"}");
+  std::string input(value);
+
+  Parser parser;
+  parser.parseInSitu(&input[0], input.size());
+  Slice s = parser.builder().slice();
+  std::shared_ptr<Builder> copied = Parser::fromJson(value);
+  Slice c = copied->slice();
+
+  Slice external = s.get("kkkkkkkkkkkk");
+  Slice string = c.get("kkkkkkkkkkkk");
+  // type() only looks at the head byte
+  ASSERT_TRUE(external.isExternal());
+  ASSERT_EQ(ValueType::External, external.type());
+  ASSERT_EQ(string.type(), external.resolveExternal().type());
+  ASSERT_EQ(text, external.copyString());
+  ASSERT_EQ(text, external.toString());
+  ASSERT_EQ(string.toString(), external.toString());
+  StringRef ref(external);
+  ASSERT_EQ(text, ref.toString());
+  // not copied
+  ASSERT_TRUE(ref.data() >= input.data() && ref.data() < input.data() + input.size());
+  ref = string;
+  ref = external;
+  ASSERT_EQ(text, ref.toString());
+  HashedStringRef hashed(external);
+  ASSERT_TRUE(HashedStringRef(string) == hashed);
+  ASSERT_EQ(text, hashed.toString());
+  hashed = string;
+  hashed = external;
+  ASSERT_EQ(text, hashed.toString());
+  ASSERT_EQ(text.size(), external.getStringLength());
+  ASSERT_EQ(0, external.compareString(text));
+  ASSERT_TRUE(external.isEqualString(text));
+  ASSERT_EQ(string.toJson(), external.toJson());
+
+  ASSERT_EQ(string.normalizedHash(), external.normalizedHash());
+  ASSERT_EQ(string.normalizedHash32(), external.normalizedHash32());
+  ASSERT_EQ(c.normalizedHash(), s.normalizedHash());
+  ASSERT_EQ(c.normalizedHash32(), s.normalizedHash32());
+  ASSERT_TRUE(NormalizedCompare::equals(c, s));
+
+  // an External is never accepted as an attribute name
+  Builder object;
+  object.openObject();
+  ASSERT_VELOCYPACK_EXCEPTION(object.add(external), Exception::BuilderKeyMustBeString);
+}
+
+TEST(ParserTest, InSituStringsTypeChecks) {
+  std::string const text(300, 'y');
+  std::string input("{\"a\":[\"" + text + "\",1],\"" + text + "\":\"" + text + "\"}");
+
+  Parser parser;
+  parser.parseInSitu(&input[0], input.size());
+  Slice s = parser.builder().slice();
+
+  // attribute names are always copied
+  ObjectIterator it(s);
+  ASSERT_TRUE(it.key().isString());
+  it.next();
+  ASSERT_TRUE(it.key().isString());
+  ASSERT_EQ(text, it.key().copyString());
+
+  // referenced values are Externals to type checks, so callers must
+  // resolve them first
+  Slice value = it.value();
+  ASSERT_FALSE(value.isString());
+  ASSERT_EQ(ValueType::External, value.type());
+  ASSERT_TRUE(value.resolveExternal().isString());
+  ASSERT_EQ(ValueType::String, value.resolveExternal().type());
+  ASSERT_EQ(text, value.copyString());
+
+  std::size_t strings = 0;
+  for (auto member : ArrayIterator(s.get("a"))) {
+    if (member.resolveExternal().isString()) {
+      ++strings;
+      ASSERT_EQ(text, member.copyString());
+    }
+  }
+  ASSERT_EQ(1UL, strings);
+}
+
+TEST(ParserTest, InSituStringsNoRoom) {
+  std::string const a(300, 'a');
+  std::string const b(300, 'b');
+  std::string const c(300, 'c');
+  std::string input("[\"" + a + "\",\"" + b + "\",\"" + c + "\"]");
+
+  Parser parser;
+  parser.parseInSitu(&input[0], input.size());
+  Slice s = parser.builder().slice();
+
+  // there is no room for a header in front of the first string, and the
+  // header of the second string overwrites all bytes between the first
+  // and the second string
+  ASSERT_TRUE(s.at(0).isString());
+  ASSERT_TRUE(s.at(1).isExternal());
+  ASSERT_TRUE(s.at(2).isString());
+  ASSERT_EQ(a, s.at(0).copyString());
+  ASSERT_EQ(b, s.at(1).copyString());
+  ASSERT_EQ(c, s.at(2).copyString());
+}
+
+TEST(ParserTest, InSituStringsOptions) {
+  Options options;
+  options.inSituStringMinLength = 3;
+  options.validateUtf8Strings = true;
+
+  // short strings only need a single byte for the header
+  std::string input("[\"ab\", \"abc\", \"\xc3\xa4\xc3\xa4\", \"abcd\", \"xyz\"]");
+  Parser parser(&options);
+  parser.parseInSitu(&input[0], input.size());
+  Slice s = parser.builder().slice();
+  ASSERT_EQ(5UL, s.length());
+  ASSERT_TRUE(s.at(0).isString());
+  for (std::size_t i = 1; i < 5; ++i) {
+    ASSERT_TRUE(s.at(i).isExternal());
+  }
+  ASSERT_EQ("[\"ab\",\"abc\",\"\xc3\xa4\xc3\xa4\",\"abcd\",\"xyz\"]", s.toJson());
+
+  // attribute names are always copied
+  std::string object("{  \"abcdefgh\":1}");
+  parser.parseInSitu(&object[0], object.size());
+  ASSERT_TRUE(parser.builder().slice().keyAt(0).isString());
+
+  std::string invalid("[  \"abc\xff\"]");
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parseInSitu(&invalid[0], invalid.size()),
+                              Exception::InvalidUtf8Sequence);
+
+  // a regular parse with the same Parser copies all strings
+  parser.parse(std::string("[  \"abcd\"]"));
+  ASSERT_TRUE(parser.builder().slice().at(0).isString());
+
+  options.disallowExternals = true;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parseInSitu(&input[0], input.size()),
+                              Exception::BuilderExternalsDisallowed);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,337 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace {
+
+Buffer<uint8_t> fromJson(std::string const& json, Options const* options = &Options::Defaults) {
+  Parser parser(options);
+  parser.parse(json);
+  Builder const& b = parser.builder();
+  Buffer<uint8_t> buffer;
+  buffer.append(b.start(), b.size());
+  return buffer;
+}
+
+void checkEquals(std::string const& expected, Buffer<uint8_t> const& buffer) {
+  Validator validator;
+  ASSERT_TRUE(validator.validate(buffer.data(), buffer.size()));
+  ASSERT_EQ(Parser::fromJson(expected)->slice().toJson(),
+            Slice(buffer.data()).toJson());
+}
+
+} // namespace
+
+TEST(PatcherTest, ReplaceSameSize) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":{\"counter\":1000,\"b\":true},\"c\":\"foo\"}");
+  ValueLength const size = buffer.size();
+  uint8_t const* data = buffer.data();
+
+  Builder value;
+  value.add(Value(2000));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "counter"}, value.slice()));
+  ASSERT_EQ(size, buffer.size());
+  ASSERT_EQ(data, buffer.data());
+  checkEquals("{\"a\":{\"counter\":2000,\"b\":true},\"c\":\"foo\"}", buffer);
+}
+
+TEST(PatcherTest, ReplaceGrowing) {
+  Buffer<uint8_t> buffer = fromJson(
+      "{\"a\":1,\"b\":{\"c\":{\"d\":\"x\",\"e\":[1,2,3]},\"f\":null},\"g\":\"z\"}");
+
+  Builder value;
+  value.add(Value("a longer string"));
+  ASSERT_TRUE(Patcher::replace(buffer, {"b", "c", "d"}, value.slice()));
+  checkEquals(
+      "{\"a\":1,\"b\":{\"c\":{\"d\":\"a longer string\",\"e\":[1,2,3]},\"f\":null},\"g\":\"z\"}",
+      buffer);
+}
+
+TEST(PatcherTest, ReplaceShrinking) {
+  Buffer<uint8_t> buffer = fromJson(
+      "{\"a\":{\"b\":[1,2,3,4,5,6,7,8,9,10],\"c\":1.5},\"d\":\"z\"}");
+
+  Builder value;
+  value.add(Value(ValueType::Null));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "b"}, value.slice()));
+  checkEquals("{\"a\":{\"b\":null,\"c\":1.5},\"d\":\"z\"}", buffer);
+}
+
+TEST(PatcherTest, ReplaceObjectValue) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":{\"b\":1},\"c\":2}");
+
+  Builder value;
+  value.openObject();
+  value.add("x", Value("y"));
+  value.add("z", Value(ValueType::Array));
+  value.close();
+  value.close();
+  ASSERT_TRUE(Patcher::replace(buffer, {"a"}, value.slice()));
+  checkEquals("{\"a\":{\"x\":\"y\",\"z\":[]},\"c\":2}", buffer);
+
+  // descend into the new value
+  Builder other;
+  other.add(Value(42));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "x"}, other.slice()));
+  checkEquals("{\"a\":{\"x\":42,\"z\":[]},\"c\":2}", buffer);
+}
+
+TEST(PatcherTest, ReplaceCompactObjects) {
+  Options options;
+  options.buildUnindexedObjects = true;
+  Buffer<uint8_t> buffer =
+      fromJson("{\"a\":{\"b\":\"x\",\"c\":2},\"d\":[1,2]}", &options);
+  ASSERT_EQ(0x14, Slice(buffer.data()).head());
+
+  Builder value;
+  value.add(Value("abcdefghijklmnopqrstuvwxyz"));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "b"}, value.slice(), &options));
+  checkEquals("{\"a\":{\"b\":\"abcdefghijklmnopqrstuvwxyz\",\"c\":2},\"d\":[1,2]}", buffer);
+}
+
+TEST(PatcherTest, ReplaceCompactObjectKeepsMinimalByteLength) {
+  Options options;
+  options.buildUnindexedObjects = true;
+  std::string const filler(120, 'f');
+  Buffer<uint8_t> buffer =
+      fromJson("{\"a\":\"" + filler + "\",\"b\":1}", &options);
+  ASSERT_EQ(0x14, buffer.data()[0]);
+  ASSERT_EQ(130UL, Slice(buffer.data()).byteSize());
+  ASSERT_EQ(0x80, buffer.data()[1] & 0x80);
+
+  // the byte length drops below 128 and needs one byte less
+  Builder value;
+  value.add(Value("short"));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a"}, value.slice(), &options));
+  ASSERT_EQ(0x14, buffer.data()[0]);
+  ValueLength const byteSize = Slice(buffer.data()).byteSize();
+  ASSERT_TRUE(byteSize < 128);
+  ASSERT_EQ(byteSize, buffer.data()[1]);
+  checkEquals("{\"a\":\"short\",\"b\":1}", buffer);
+
+  // and grows beyond 127 again
+  Builder longer;
+  longer.add(Value(filler));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a"}, longer.slice(), &options));
+  ASSERT_EQ(130UL, Slice(buffer.data()).byteSize());
+  ASSERT_EQ(0x80, buffer.data()[1] & 0x80);
+  checkEquals("{\"a\":\"" + filler + "\",\"b\":1}", buffer);
+}
+
+TEST(PatcherTest, ReplaceRebuildsWhenHeaderIsTooSmall) {
+  // the inner Object uses 1-byte offsets, the outer one 2-byte offsets
+  std::string const filler(200, 'f');
+  std::string const json = "{\"a\":{\"b\":\"x\",\"c\":\"" + filler +
+                           "\"},\"d\":\"" + filler + "\",\"e\":1}";
+  Buffer<uint8_t> buffer = fromJson(json);
+  ASSERT_EQ(0x0b, Slice(buffer.data()).get("a").head());
+  ASSERT_EQ(0x0c, Slice(buffer.data()).head());
+
+  std::string const longer(100, 'l');
+  Builder value;
+  value.add(Value(longer));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "b"}, value.slice()));
+  ASSERT_EQ(0x0c, Slice(buffer.data()).get("a").head());
+  checkEquals("{\"a\":{\"b\":\"" + longer + "\",\"c\":\"" + filler +
+              "\"},\"d\":\"" + filler + "\",\"e\":1}", buffer);
+
+  // and shrink it again
+  Builder shorter;
+  shorter.add(Value("x"));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "b"}, shorter.slice()));
+  checkEquals(json, buffer);
+}
+
+TEST(PatcherTest, ReplaceRebuildsOuterObject) {
+  Buffer<uint8_t> buffer = fromJson(
+      "{\"a\":{\"b\":{\"c\":1,\"d\":2},\"e\":3},\"f\":4,\"g\":5}");
+  ASSERT_EQ(0x0b, Slice(buffer.data()).head());
+
+  // the innermost Objects get 2-byte offsets, the outermost one as well
+  std::string const longer(300, 'l');
+  Builder value;
+  value.add(Value(longer));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a", "b", "c"}, value.slice()));
+  ASSERT_EQ(0x0c, Slice(buffer.data()).head());
+  checkEquals("{\"a\":{\"b\":{\"c\":\"" + longer +
+              "\",\"d\":2},\"e\":3},\"f\":4,\"g\":5}", buffer);
+}
+
+TEST(PatcherTest, ReplaceRebuildsTranslatedKeys) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  std::string const filler(100, 'f');
+  std::string const longer(200, 'l');
+  Builder value;
+  value.add(Value(longer));
+
+  // the keys keep their encoding
+  auto checkKeys = [&filler, &longer](Slice s) {
+    ASSERT_EQ(3UL, s.length());
+    ObjectIterator it(s, true);
+    ASSERT_EQ("a", it.key(false).copyString());
+    ASSERT_EQ(longer, it.value().copyString());
+    it.next();
+    ASSERT_EQ(2UL, it.key(false).getUInt());
+    ASSERT_EQ(filler, it.value().copyString());
+    it.next();
+    ASSERT_EQ(1UL, it.key(false).getUInt());
+    ASSERT_EQ(3, it.value().getInt());
+  };
+
+  {
+    // a compact Object can be built without a default translator. its
+    // byte length needs a second byte afterwards
+    options.buildUnindexedObjects = true;
+    Builder b(&options);
+    b.openObject();
+    b.add("a", Value("x"));
+    b.add("bar", Value(filler));
+    b.add("foo", Value(3));
+    b.close();
+    Buffer<uint8_t> buffer;
+    buffer.append(b.start(), b.size());
+    ASSERT_EQ(0x14, Slice(buffer.data()).head());
+
+    ASSERT_TRUE(Patcher::replace(buffer, {"a"}, value.slice(), &options));
+    Slice s(buffer.data());
+    Validator validator;
+    ASSERT_TRUE(validator.validate(s.start(), s.byteSize()));
+    checkKeys(s);
+  }
+
+  {
+    AttributeTranslatorScope scope(translator.get());
+    options.buildUnindexedObjects = false;
+    Builder b(&options);
+    b.openObject();
+    b.add("a", Value("x"));
+    b.add("bar", Value(filler));
+    b.add("foo", Value(3));
+    b.close();
+    Buffer<uint8_t> buffer;
+    buffer.append(b.start(), b.size());
+    ASSERT_EQ(0x0b, Slice(buffer.data()).head());
+
+    // the index table needs wider offsets afterwards
+    ASSERT_TRUE(Patcher::replace(buffer, {"a"}, value.slice(), &options));
+    Slice s(buffer.data());
+    ASSERT_EQ(0x0c, s.head());
+    ASSERT_EQ(filler, s.get("bar").copyString());
+    ASSERT_EQ(3, s.get("foo").getInt());
+    checkKeys(s);
+  }
+}
+
+TEST(PatcherTest, ReplaceKeepsTrailingData) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":1,\"b\":2}");
+  ValueLength const size = buffer.size();
+  Builder trailing;
+  trailing.add(Value("trailing"));
+  buffer.append(trailing.start(), trailing.size());
+
+  Builder value;
+  value.add(Value("value"));
+  ASSERT_TRUE(Patcher::replace(buffer, {"a"}, value.slice()));
+  Slice s(buffer.data());
+  ASSERT_EQ(size + 5, s.byteSize());
+  ASSERT_EQ(size + 5 + trailing.size(), buffer.size());
+  ASSERT_EQ("trailing", Slice(buffer.data() + s.byteSize()).copyString());
+}
+
+TEST(PatcherTest, ReplaceValueFromSameBuffer) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":1,\"b\":[1,2,3]}");
+
+  Slice value = Slice(buffer.data()).get("b");
+  ASSERT_TRUE(Patcher::replace(buffer, {"a"}, value));
+  checkEquals("{\"a\":[1,2,3],\"b\":[1,2,3]}", buffer);
+}
+
+TEST(PatcherTest, ReplaceStringRefPath) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":{\"b\":false}}");
+
+  Builder value;
+  value.add(Value(true));
+  std::vector<StringRef> path{StringRef("a"), StringRef("b")};
+  ASSERT_TRUE(Patcher::replace(buffer, path, value.slice()));
+  checkEquals("{\"a\":{\"b\":true}}", buffer);
+}
+
+TEST(PatcherTest, ReplaceNotFound) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":{\"b\":1},\"c\":2}");
+  std::string const before = buffer.toString();
+
+  Builder value;
+  value.add(Value(1));
+  ASSERT_FALSE(Patcher::replace(buffer, {"x"}, value.slice()));
+  ASSERT_FALSE(Patcher::replace(buffer, {"a", "x"}, value.slice()));
+  ASSERT_FALSE(Patcher::replace(buffer, {"c", "x"}, value.slice()));
+  ASSERT_EQ(before, buffer.toString());
+}
+
+TEST(PatcherTest, ReplaceInvalid) {
+  Buffer<uint8_t> buffer = fromJson("[1,2,3]");
+
+  Builder value;
+  value.add(Value(1));
+  ASSERT_VELOCYPACK_EXCEPTION(Patcher::replace(buffer, {"a"}, value.slice()),
+                              Exception::InvalidValueType);
+
+  buffer = fromJson("{}");
+  ASSERT_VELOCYPACK_EXCEPTION(
+      Patcher::replace(buffer, std::vector<std::string>(), value.slice()),
+      Exception::InvalidAttributePath);
+}
+
+TEST(PatcherTest, ReplaceInPlace) {
+  Buffer<uint8_t> buffer = fromJson("{\"a\":{\"hits\":12345678,\"b\":1.5}}");
+
+  Builder value;
+  value.add(Value(87654));
+  ASSERT_TRUE(Patcher::replaceInPlace(buffer.data(), {"a", "hits"}, value.slice()));
+  checkEquals("{\"a\":{\"hits\":87654,\"b\":1.5}}", buffer);
+
+  Builder bigger;
+  bigger.add(Value(int64_t(1234567890123LL)));
+  ASSERT_FALSE(Patcher::replaceInPlace(buffer.data(), {"a", "hits"}, bigger.slice()));
+  ASSERT_FALSE(Patcher::replaceInPlace(buffer.data(), {"a", "x"}, value.slice()));
+  checkEquals("{\"a\":{\"hits\":87654,\"b\":1.5}}", buffer);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace reflection {
+
+struct Point {
+  int64_t x = 0;
+  int64_t y = 0;
+};
+
+struct Shape {
+  std::string name;
+  uint32_t id = 0;
+  double scale = 1.0;
+  bool visible = false;
+  Point origin;
+  std::vector<Point> points;
+  std::vector<std::string> tags;
+};
+
+struct Wide {
+  int f0 = 0, f1 = 0, f2 = 0, f3 = 0, f4 = 0, f5 = 0, f6 = 0, f7 = 0,
+      f8 = 0, f9 = 0, f10 = 0, f11 = 0, f12 = 0, f13 = 0, f14 = 0, f15 = 0,
+      f16 = 0, f17 = 0, f18 = 0, f19 = 0, f20 = 0, f21 = 0, f22 = 0, f23 = 0,
+      f24 = 0, f25 = 0, f26 = 0, f27 = 0, f28 = 0, f29 = 0, f30 = 0, f31 = 0,
+      f32 = 0, f33 = 0, f34 = 0, f35 = 0, f36 = 0, f37 = 0, f38 = 0, f39 = 0;
+};
+
+Point point(int64_t x, int64_t y) {
+  Point p;
+  p.x = x;
+  p.y = y;
+  return p;
+}
+
+} // namespace reflection
+
+VELOCYPACK_REFLECT(reflection::Point, x, y)
+VELOCYPACK_REFLECT(reflection::Shape, name, id, scale, visible, origin, points, tags)
+VELOCYPACK_REFLECT(reflection::Wide, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9,
+                   f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21,
+                   f22, f23, f24, f25, f26, f27, f28, f29, f30, f31, f32, f33,
+                   f34, f35, f36, f37, f38, f39)
+
+using reflection::Point;
+using reflection::Shape;
+using reflection::Wide;
+using reflection::point;
+
+TEST(ReflectionTest, Fields) {
+  ASSERT_EQ(2UL, ReflectFields<Point>::size());
+  ASSERT_EQ(7UL, ReflectFields<Shape>::size());
+  ASSERT_EQ(40UL, ReflectFields<Wide>::size());
+  ASSERT_EQ("x", ReflectFields<Point>::names()[0].toString());
+  ASSERT_EQ("tags", ReflectFields<Shape>::names()[6].toString());
+}
+
+TEST(ReflectionTest, Index) {
+  ReflectIndex const& index = Reflect::index<Wide>();
+  for (std::size_t i = 0; i < 40; ++i) {
+    ASSERT_EQ(i, index.find(StringRef("f" + std::to_string(i))));
+  }
+  ASSERT_EQ(ReflectIndex::notFound, index.find(StringRef("f40")));
+  ASSERT_EQ(ReflectIndex::notFound, index.find(StringRef("")));
+  ASSERT_EQ(ReflectIndex::notFound, index.find(StringRef("f")));
+}
+
+TEST(ReflectionTest, Encode) {
+  Shape shape;
+  shape.name = "triangle";
+  shape.id = 7;
+  shape.scale = 2.5;
+  shape.visible = true;
+  shape.origin.x = -1;
+  shape.origin.y = 1;
+  shape.points = {point(0, 0), point(3, 0), point(0, 4)};
+  shape.tags = {"a", "b"};
+
+  Builder b;
+  Reflect::toVelocyPack(shape, b);
+  ASSERT_EQ(
+      Parser::fromJson("{\"name\":\"triangle\",\"id\":7,\"scale\":2.5,"
+                       "\"visible\":true,\"origin\":{\"x\":-1,\"y\":1},"
+                       "\"points\":[{\"x\":0,\"y\":0},{\"x\":3,\"y\":0},"
+                       "{\"x\":0,\"y\":4}],\"tags\":[\"a\",\"b\"]}")
+          ->slice()
+          .toJson(),
+      b.slice().toJson());
+
+  // as a member of an open Object
+  Builder outer;
+  outer.openObject();
+  outer.add("shape", Value(ValueType::Object));
+  ReflectFields<Shape>::encode(outer, shape);
+  outer.close();
+  outer.add(Value("origin"));
+  Reflect::toVelocyPack(shape.origin, outer);
+  outer.close();
+  ASSERT_EQ(-1, outer.slice().get("origin").get("x").getInt());
+  ASSERT_EQ("triangle", outer.slice().get("shape").get("name").copyString());
+}
+
+TEST(ReflectionTest, RoundTrip) {
+  Shape shape;
+  shape.name = "square";
+  shape.id = 4000000000U;
+  shape.scale = -0.25;
+  shape.origin.y = 1234567890123;
+  shape.points = {point(1, 2)};
+
+  Builder b;
+  Reflect::toVelocyPack(shape, b);
+  Shape copy = Reflect::fromVelocyPack<Shape>(b.slice());
+  ASSERT_EQ(shape.name, copy.name);
+  ASSERT_EQ(shape.id, copy.id);
+  ASSERT_EQ(shape.scale, copy.scale);
+  ASSERT_EQ(shape.visible, copy.visible);
+  ASSERT_EQ(shape.origin.x, copy.origin.x);
+  ASSERT_EQ(shape.origin.y, copy.origin.y);
+  ASSERT_EQ(1UL, copy.points.size());
+  ASSERT_EQ(2, copy.points[0].y);
+  ASSERT_TRUE(copy.tags.empty());
+}
+
+TEST(ReflectionTest, DecodeIgnoresUnknownAttributes) {
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      "{\"tags\":[\"z\"],\"unknown\":[1,2,3],\"visible\":true,"
+      "\"origin\":{\"y\":5,\"z\":6},\"name\":\"n\"}");
+
+  Shape shape;
+  shape.id = 99;
+  shape.points = {point(1, 1)};
+  Reflect::fromVelocyPack(b->slice(), shape);
+  ASSERT_EQ("n", shape.name);
+  ASSERT_TRUE(shape.visible);
+  ASSERT_EQ(5, shape.origin.y);
+  ASSERT_EQ(0, shape.origin.x);
+  ASSERT_EQ(std::vector<std::string>{"z"}, shape.tags);
+  // attributes that are missing leave their fields alone
+  ASSERT_EQ(99U, shape.id);
+  ASSERT_EQ(1UL, shape.points.size());
+}
+
+TEST(ReflectionTest, DecodeCompactObjects) {
+  Options options;
+  options.buildUnindexedObjects = true;
+  Parser parser(&options);
+  parser.parse("{\"y\":2,\"x\":1}");
+  ASSERT_EQ(0x14, parser.builder().slice().head());
+
+  Point p = Reflect::fromVelocyPack<Point>(parser.builder().slice());
+  ASSERT_EQ(1, p.x);
+  ASSERT_EQ(2, p.y);
+}
+
+TEST(ReflectionTest, DecodeErrors) {
+  Point p;
+  ASSERT_VELOCYPACK_EXCEPTION(
+      Reflect::fromVelocyPack(Parser::fromJson("[1,2]")->slice(), p),
+      Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(
+      Reflect::fromVelocyPack(Parser::fromJson("{\"x\":\"1\"}")->slice(), p),
+      Exception::InvalidValueType);
+
+  Shape shape;
+  ASSERT_VELOCYPACK_EXCEPTION(
+      Reflect::fromVelocyPack(Parser::fromJson("{\"id\":-1}")->slice(), shape),
+      Exception::NumberOutOfRange);
+  ASSERT_VELOCYPACK_EXCEPTION(
+      Reflect::fromVelocyPack(Parser::fromJson("{\"points\":{}}")->slice(), shape),
+      Exception::InvalidValueType);
+}
+
+TEST(ReflectionTest, DuplicateNames) {
+  StringRef names[] = {StringRef("a"), StringRef("b"), StringRef("a")};
+  ASSERT_VELOCYPACK_EXCEPTION(ReflectIndex(names, 3), Exception::InternalError);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
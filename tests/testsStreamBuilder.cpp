@@ -0,0 +1,369 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace {
+
+void checkEquals(std::string const& expected, std::string const& data) {
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(data.data());
+  Validator validator;
+  ASSERT_TRUE(validator.validate(p, data.size()));
+  ASSERT_EQ(data.size(), Slice(p).byteSize());
+  ASSERT_EQ(Parser::fromJson(expected)->slice().toJson(), Slice(p).toJson());
+}
+
+// appends to a string. reports its position, but cannot seek back if
+// seekable is false, and cannot even report its position if tellable
+// is false
+struct AppendOnlyStreamBuf : public std::streambuf {
+  explicit AppendOnlyStreamBuf(bool tellable) : tellable(tellable) {}
+
+  int_type overflow(int_type c) override {
+    if (c != traits_type::eof()) {
+      data.push_back(static_cast<char>(c));
+    }
+    return c;
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode) override {
+    if (tellable && off == 0 && dir == std::ios_base::cur) {
+      return pos_type(static_cast<off_type>(data.size()));
+    }
+    return pos_type(off_type(-1));
+  }
+
+  bool tellable;
+  std::string data;
+};
+
+} // namespace
+
+TEST(StreamBuilderTest, Array) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  ASSERT_FALSE(b.isOpen());
+  b.openArray();
+  ASSERT_TRUE(b.isOpen());
+  b.add(Parser::fromJson("1")->slice());
+  b.add(Parser::fromJson("\"foo\"")->slice());
+  b.add(Parser::fromJson("[1,2,{\"a\":null}]")->slice());
+  ASSERT_EQ(3UL, b.length());
+  b.close();
+  ASSERT_FALSE(b.isOpen());
+
+  Slice s(reinterpret_cast<uint8_t const*>(data.data()));
+  ASSERT_EQ(0x09, s.head());
+  ASSERT_EQ(3UL, s.length());
+  ASSERT_EQ("foo", s.at(1).copyString());
+  ASSERT_EQ(2UL, s.at(2).at(1).getUInt());
+  checkEquals("[1,\"foo\",[1,2,{\"a\":null}]]", data);
+}
+
+TEST(StreamBuilderTest, Object) {
+  Buffer<char> buffer;
+  CharBufferSink sink(&buffer);
+  StreamBuilder b(&sink);
+  b.openObject();
+  std::string const longKey(200, 'k');
+  b.add(StringRef("b"), Parser::fromJson("true")->slice());
+  b.add(StringRef(longKey), Parser::fromJson("{\"x\":[1]}")->slice());
+  b.add(StringRef(""), Parser::fromJson("\"empty\"")->slice());
+  b.add(StringRef("a"), Parser::fromJson("null")->slice());
+  b.close();
+
+  std::string data(buffer.data(), buffer.size());
+  Slice s(reinterpret_cast<uint8_t const*>(data.data()));
+  ASSERT_EQ(0x0e, s.head());
+  ASSERT_EQ(4UL, s.length());
+  ASSERT_TRUE(s.get("b").getBool());
+  ASSERT_TRUE(s.get("a").isNull());
+  ASSERT_EQ("empty", s.get("").copyString());
+  ASSERT_EQ(1UL, s.get(longKey).get("x").at(0).getUInt());
+  // the index table is sorted by attribute name
+  ASSERT_EQ("", s.keyAt(0).copyString());
+  ASSERT_EQ("a", s.keyAt(1).copyString());
+  ASSERT_EQ("b", s.keyAt(2).copyString());
+  ASSERT_EQ(longKey, s.keyAt(3).copyString());
+  checkEquals("{\"\":\"empty\",\"a\":null,\"b\":true,\"" + longKey + "\":{\"x\":[1]}}", data);
+}
+
+TEST(StreamBuilderTest, Builder) {
+  std::ostringstream out;
+  StringStreamSink sink(&out);
+  StreamBuilder b(&sink);
+  b.openObject();
+  b.builder().add(Value("a"));
+  b.builder().openArray();
+  b.builder().add(Value(1));
+  b.builder().close();
+  b.builder().add(Value("b"));
+  b.builder().add(Value(2));
+  b.flush();
+  ASSERT_EQ(2UL, b.length());
+  ASSERT_TRUE(b.builder().isEmpty());
+  b.add(StringRef("c"), Parser::fromJson("3")->slice());
+  b.builder().add(Value("d"));
+  b.builder().add(Value(4));
+  // the builder is flushed by close()
+  b.close();
+
+  checkEquals("{\"a\":[1],\"b\":2,\"c\":3,\"d\":4}", out.str());
+}
+
+TEST(StreamBuilderTest, ManyMembers) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  b.openArray();
+  std::string expected = "[";
+  for (std::size_t i = 0; i < 1000; ++i) {
+    b.builder().add(Value(i));
+    if (i % 100 == 99) {
+      b.flush();
+    }
+    if (i > 0) {
+      expected.push_back(',');
+    }
+    expected.append(std::to_string(i));
+  }
+  expected.push_back(']');
+  b.close();
+
+  Slice s(reinterpret_cast<uint8_t const*>(data.data()));
+  ASSERT_EQ(1000UL, s.length());
+  ASSERT_EQ(567UL, s.at(567).getUInt());
+  ValueLength i = 0;
+  for (auto it : ArrayIterator(s)) {
+    ASSERT_EQ(i++, it.getUInt());
+  }
+  checkEquals(expected, data);
+}
+
+TEST(StreamBuilderTest, Empty) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  b.openArray();
+  b.close();
+  b.openObject();
+  b.close();
+  ASSERT_EQ(2UL, data.size());
+  ASSERT_EQ(0x01, static_cast<uint8_t>(data[0]));
+  ASSERT_EQ(0x0a, static_cast<uint8_t>(data[1]));
+}
+
+TEST(StreamBuilderTest, Sequence) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  b.openArray();
+  b.add(Parser::fromJson("1")->slice());
+  b.close();
+  std::size_t const first = data.size();
+  b.openObject();
+  b.add(StringRef("a"), Parser::fromJson("2")->slice());
+  b.close();
+
+  checkEquals("[1]", data.substr(0, first));
+  checkEquals("{\"a\":2}", data.substr(first));
+}
+
+TEST(StreamBuilderTest, Errors) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  auto builder = Parser::fromJson("1");
+  Slice value = builder->slice();
+
+  ASSERT_VELOCYPACK_EXCEPTION(b.add(value), Exception::BuilderNeedOpenCompound);
+  ASSERT_VELOCYPACK_EXCEPTION(b.close(), Exception::BuilderNeedOpenCompound);
+
+  b.openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(b.openObject(), Exception::BuilderNotSealed);
+  ASSERT_VELOCYPACK_EXCEPTION(b.add(StringRef("a"), value),
+                              Exception::BuilderNeedOpenObject);
+  b.builder().openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(b.flush(), Exception::BuilderNotSealed);
+  b.builder().close();
+  b.close();
+
+  b.openObject();
+  ASSERT_VELOCYPACK_EXCEPTION(b.add(value), Exception::BuilderNeedOpenArray);
+  b.builder().add(Value(1));
+  b.builder().add(Value(2));
+  ASSERT_VELOCYPACK_EXCEPTION(b.flush(), Exception::BuilderKeyMustBeString);
+  b.builder().clear();
+  b.builder().add(Value("a"));
+  ASSERT_VELOCYPACK_EXCEPTION(b.flush(), Exception::BuilderKeyMustBeString);
+
+  ASSERT_VELOCYPACK_EXCEPTION(StreamBuilder(nullptr), Exception::InternalError);
+}
+
+TEST(StreamBuilderTest, OutputStream) {
+  std::ostringstream stream;
+  StringStreamSink sink(&stream);
+  StreamBuilder b(&sink);
+  b.openArray();
+  b.add(Parser::fromJson("[1,2,3]")->slice());
+  b.close();
+  checkEquals("[[1,2,3]]", stream.str());
+}
+
+TEST(StreamBuilderTest, MembersStreamed) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  b.openArray();
+  // nothing is written before the first member
+  ASSERT_TRUE(data.empty());
+  std::string expected = "[";
+  for (std::size_t i = 0; i < 200; ++i) {
+    std::string const value(i % 10, 'x');
+    b.builder().add(Value(value));
+    // every member is in the sink as soon as it is flushed, after the
+    // header with the placeholder byte length for the first one
+    std::size_t const expectedSize =
+        data.size() + b.builder().size() + (i == 0 ? 1 + 8 : 0);
+    b.flush();
+    ASSERT_EQ(expectedSize, data.size());
+    if (i > 0) {
+      expected.push_back(',');
+    }
+    expected.append("\"" + value + "\"");
+  }
+  expected.push_back(']');
+  std::size_t const members = data.size();
+  b.close();
+  // close() only appends the index table and the number of members
+  ASSERT_EQ(members + 8 * 200 + 8, data.size());
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(data.data());
+  ASSERT_EQ(0x09, p[0]);
+  ASSERT_EQ(data.size(), readUInt64(p + 1));
+  ASSERT_EQ(200UL, readUInt64(p + data.size() - 8));
+  checkEquals(expected, data);
+}
+
+TEST(StreamBuilderTest, ManyAttributes) {
+  std::string data;
+  StringSink sink(&data);
+  StreamBuilder b(&sink);
+  b.openObject();
+  // the names are not added in sorted order
+  for (std::size_t i = 0; i < 1000; ++i) {
+    std::string const name = "key" + std::to_string((i * 7919) % 1000);
+    b.builder().add(Value(name));
+    b.builder().add(Value(i));
+    if (i % 100 == 99) {
+      b.flush();
+    }
+  }
+  b.close();
+
+  Slice s(reinterpret_cast<uint8_t const*>(data.data()));
+  Validator validator;
+  ASSERT_TRUE(validator.validate(s.start(), data.size()));
+  ASSERT_EQ(1000UL, s.length());
+  for (std::size_t i = 0; i < 1000; ++i) {
+    std::string const name = "key" + std::to_string((i * 7919) % 1000);
+    ASSERT_EQ(i, s.get(name).getUInt());
+  }
+  ASSERT_TRUE(s.get("key1000").isNone());
+}
+
+TEST(StreamBuilderTest, DuplicateAttributes) {
+  auto builder = Parser::fromJson("1");
+  Slice value = builder->slice();
+  {
+    std::string data;
+    StringSink sink(&data);
+    StreamBuilder b(&sink);
+    b.openObject();
+    b.add(StringRef("a"), value);
+    b.add(StringRef("a"), value);
+    b.close();
+    Slice s(reinterpret_cast<uint8_t const*>(data.data()));
+    ASSERT_EQ(2UL, s.length());
+    ASSERT_EQ(1, s.get("a").getInt());
+  }
+  {
+    Options options;
+    options.checkAttributeUniqueness = true;
+    std::string data;
+    StringSink sink(&data);
+    StreamBuilder b(&sink, &options);
+    b.openObject();
+    b.add(StringRef("b"), value);
+    b.add(StringRef("a"), value);
+    b.add(StringRef("b"), value);
+    ASSERT_VELOCYPACK_EXCEPTION(b.close(), Exception::DuplicateAttributeName);
+    ASSERT_FALSE(b.isOpen());
+
+    std::size_t const first = data.size();
+    b.openObject();
+    b.add(StringRef("b"), value);
+    b.add(StringRef("a"), value);
+    b.close();
+    checkEquals("{\"a\":1,\"b\":1}", data.substr(first));
+  }
+}
+
+TEST(StreamBuilderTest, OutputStreamNotSeekable) {
+  auto builder = Parser::fromJson("1");
+  Slice value = builder->slice();
+  {
+    AppendOnlyStreamBuf buf(false);
+    std::ostream stream(&buf);
+    StreamSinkImpl<std::ostream> sink(&stream);
+    StreamBuilder b(&sink);
+    b.openArray();
+    // the header position cannot be determined
+    ASSERT_VELOCYPACK_EXCEPTION(b.add(value), Exception::InternalError);
+  }
+  {
+    AppendOnlyStreamBuf buf(true);
+    std::ostream stream(&buf);
+    StreamSinkImpl<std::ostream> sink(&stream);
+    StreamBuilder b(&sink);
+    b.openArray();
+    b.add(value);
+    // the byte length cannot be written into the header
+    ASSERT_VELOCYPACK_EXCEPTION(b.close(), Exception::InternalError);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
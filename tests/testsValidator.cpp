@@ -2380,6 +2380,24 @@ TEST(ValidatorTest, ObjectFourByteManyEntries) {
   ASSERT_TRUE(validator.validate(b.slice().start(), b.slice().byteSize()));
 }
 
+TEST(ValidatorTest, ObjectEightByte) {
+  std::string const value("\x0e\x1c\x00\x00\x00\x00\x00\x00\x00\x41\x61\x31"
+                          "\x09\x00\x00\x00\x00\x00\x00\x00\x01\x00\x00\x00\x00\x00\x00\x00", 28);
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+  ASSERT_EQ(1, Slice(reinterpret_cast<uint8_t const*>(value.data())).get("a").getInt());
+}
+
+TEST(ValidatorTest, ObjectEightByteNrItemsWrong) {
+  std::string const value("\x0e\x24\x00\x00\x00\x00\x00\x00\x00\x41\x61\x31"
+                          "\x09\x00\x00\x00\x00\x00\x00\x00\x09\x00\x00\x00\x00\x00\x00\x00"
+                          "\x02\x00\x00\x00\x00\x00\x00\x00", 36);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
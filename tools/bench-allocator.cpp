@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0]
+            << " FILENAME.json RUNTIME_IN_SECONDS THREADS TYPE" << std::endl;
+  std::cout << "This program reads the file into a string and lets THREADS"
+            << std::endl;
+  std::cout << "threads handle it as a request over and over again: each"
+            << std::endl;
+  std::cout << "request parses the input into a fresh Builder and builds a"
+            << std::endl;
+  std::cout << "small response from it in another fresh Builder."
+            << std::endl;
+  std::cout << "TYPE must be either 'malloc' (Builders use the heap) or"
+            << std::endl;
+  std::cout << "'arena' (Builders use a per-thread ArenaMemoryResource that"
+            << std::endl;
+  std::cout << "is released after each request)." << std::endl;
+}
+
+static std::string tryReadFile(std::string const& filename) {
+  std::string s;
+  std::ifstream ifs(filename.c_str(), std::ifstream::in);
+
+  if (!ifs.is_open()) {
+    throw "cannot open input file";
+  }
+
+  char buffer[4096];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    s.append(buffer, ifs.gcount());
+  }
+  ifs.close();
+
+  return s;
+}
+
+static std::string readFile(std::string filename) {
+  try {
+    return tryReadFile(filename);
+  } catch (...) {
+  }
+#ifdef _WIN32
+  std::string const separator("\\");
+#else
+  std::string const separator("/");
+#endif
+  filename = "tests" + separator + "jsonSample" + separator + filename;
+
+  for (size_t i = 0; i < 3; ++i) {
+    try {
+      return tryReadFile(filename);
+    } catch (...) {
+      filename = ".." + separator + filename;
+    }
+  }
+  std::cerr << "Cannot open input file '" << filename << "'" << std::endl;
+  ::exit(EXIT_FAILURE);
+}
+
+enum class AllocatorType { Malloc, Arena };
+
+static char const* allocatorTypeName(AllocatorType type) {
+  switch (type) {
+    case AllocatorType::Malloc:
+      return "malloc";
+    case AllocatorType::Arena:
+      return "arena";
+  }
+  return "unknown";
+}
+
+// a request: parse the input and answer with the top-level keys (or the
+// number of members) of the parsed value
+static std::size_t handleRequest(Builder& request, Builder& response,
+                                 std::string const& input) {
+  Parser parser(request);
+  parser.parse(input);
+
+  Slice s = request.slice();
+  response.openObject();
+  response.add("type", Value(s.typeName()));
+  if (s.isObject()) {
+    response.add("keys", Value(ValueType::Array));
+    for (auto const& it : ObjectIterator(s, true)) {
+      response.add(it.key);
+    }
+    response.close();
+  } else if (s.isArray()) {
+    response.add("length", Value(s.length()));
+  }
+  response.close();
+  return response.size();
+}
+
+static void runThread(std::string const& input, AllocatorType type,
+                      std::atomic<bool>& start, std::atomic<bool>& stop,
+                      uint64_t& requests) {
+  ArenaMemoryResource arena(64 * 1024);
+  uint64_t count = 0;
+  std::size_t sum = 0;
+
+  while (!start.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+
+  while (!stop.load(std::memory_order_relaxed)) {
+    if (type == AllocatorType::Arena) {
+      {
+        Builder request(arena);
+        Builder response(arena);
+        sum += handleRequest(request, response, input);
+      }
+      // all memory of the request goes back at once
+      arena.release();
+    } else {
+      Builder request;
+      Builder response;
+      sum += handleRequest(request, response, input);
+    }
+    ++count;
+  }
+
+  if (sum == 0) {
+    std::cerr << "Unexpected empty response" << std::endl;
+  }
+  requests = count;
+}
+
+static double run(std::string const& input, int runTime, std::size_t threads,
+                  AllocatorType type, bool fullOutput) {
+  std::atomic<bool> start(false);
+  std::atomic<bool> stop(false);
+  std::vector<uint64_t> requests(threads, 0);
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&input, type, &start, &stop, &requests, i]() {
+      runThread(input, type, start, stop, requests[i]);
+    });
+  }
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  start.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::seconds(runTime));
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& it : workers) {
+    it.join();
+  }
+  auto endTime = std::chrono::high_resolution_clock::now();
+
+  uint64_t total = 0;
+  for (auto const& it : requests) {
+    total += it;
+  }
+  std::chrono::duration<double> totalTime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(endTime - startTime);
+  double const rate = total / totalTime.count();
+
+  if (fullOutput) {
+    std::cout << "Total runtime: " << totalTime.count() << " s" << std::endl;
+    std::cout << "Have handled " << total << " requests with " << threads
+              << " threads using " << allocatorTypeName(type) << "."
+              << std::endl;
+    std::cout << "This is " << rate << " requests/s, "
+              << rate * input.size() / (1024.0 * 1024.0) << " MB/s."
+              << std::endl;
+  } else {
+    std::cout << " " << rate << " requests/s." << std::flush;
+  }
+  return rate;
+}
+
+static void runDefaultBench() {
+  std::size_t maxThreads = std::thread::hardware_concurrency();
+  if (maxThreads == 0) {
+    maxThreads = 1;
+  }
+
+  auto runComparison = [&](std::string const& filename) {
+    std::string input = readFile(filename);
+
+    std::cout << std::endl;
+    std::cout << "# " << filename << " ";
+    for (size_t i = 0; i < 30 - filename.size(); ++i) {
+      std::cout << "#";
+    }
+    std::cout << std::endl;
+
+    for (std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+      std::cout << "threads: " << threads << std::endl;
+      std::cout << "  malloc:";
+      double m = run(input, 2, threads, AllocatorType::Malloc, false);
+      std::cout << std::endl << "  arena: ";
+      double a = run(input, 2, threads, AllocatorType::Arena, false);
+      std::cout << std::endl << "  arena / malloc: " << a / m << std::endl;
+    }
+  };
+
+  runComparison("small.json");
+  runComparison("sample.json");
+  runComparison("commits.json");
+  runComparison("api-docs.json");
+  runComparison("countries.json");
+  runComparison("directory-tree.json");
+  runComparison("doubles-small.json");
+  runComparison("file-list.json");
+  runComparison("object.json");
+  runComparison("pass1.json");
+  runComparison("random1.json");
+  runComparison("random2.json");
+  runComparison("random3.json");
+}
+
+int main(int argc, char* argv[]) {
+  if (argc == 1) {
+    runDefaultBench();
+    return EXIT_SUCCESS;
+  }
+
+  if (argc != 5) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  AllocatorType type;
+  if (::strcmp(argv[4], "malloc") == 0) {
+    type = AllocatorType::Malloc;
+  } else if (::strcmp(argv[4], "arena") == 0) {
+    type = AllocatorType::Arena;
+  } else {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  std::size_t threads = std::stoul(argv[3]);
+  int runTime = std::stoi(argv[2]);
+  if (threads == 0 || runTime <= 0) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  std::string input = readFile(argv[1]);
+  run(input, runTime, threads, type, true);
+
+  return EXIT_SUCCESS;
+}
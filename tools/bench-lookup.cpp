@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " [RUNTIME_PER_CASE_IN_MS]" << std::endl;
+  std::cout << "This program measures Slice::get() on indexed Objects of"
+            << std::endl;
+  std::cout << "growing size with 1, 2, 4 and 8 byte wide index tables."
+            << std::endl;
+  std::cout << "Each Object is looked up once as it is (sorted index table,"
+            << std::endl;
+  std::cout << "binary search from the built-in cutoff on) and once marked"
+            << std::endl;
+  std::cout << "as unsorted, which forces the linear search." << std::endl;
+}
+
+static std::string keyName(std::size_t i) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "key%07zu", i);
+  return std::string(buffer);
+}
+
+static void appendInteger(std::vector<uint8_t>& out, uint64_t value,
+                          std::size_t width) {
+  for (std::size_t i = 0; i < width; ++i) {
+    out.push_back(static_cast<uint8_t>(value & 0xff));
+    value >>= 8;
+  }
+}
+
+static void storeInteger(uint8_t* dst, uint64_t value, std::size_t width) {
+  for (std::size_t i = 0; i < width; ++i) {
+    dst[i] = static_cast<uint8_t>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+// builds a sorted indexed Object with n members and index entries of the
+// given width, which the Builder would not choose for small Objects.
+// returns an empty vector if the Object does not fit into the width
+static std::vector<uint8_t> makeObject(std::size_t n, std::size_t width) {
+  std::vector<uint8_t> out;
+  std::size_t const headerSize = (width < 8) ? 1 + 2 * width : 1 + width;
+  out.resize(headerSize);
+
+  std::vector<uint64_t> offsets;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::string const key = keyName(i);
+    offsets.push_back(out.size());
+    out.push_back(static_cast<uint8_t>(0x40 + key.size()));
+    out.insert(out.end(), key.begin(), key.end());
+    out.push_back(static_cast<uint8_t>(0x30 + i % 10));
+  }
+  for (uint64_t offset : offsets) {
+    appendInteger(out, offset, width);
+  }
+  if (width == 8) {
+    appendInteger(out, n, width);
+  }
+  if (width < 8 && out.size() >= (uint64_t(1) << (8 * width))) {
+    return std::vector<uint8_t>();
+  }
+
+  out[0] = static_cast<uint8_t>(width == 1 ? 0x0b : width == 2 ? 0x0c : width == 4 ? 0x0d : 0x0e);
+  storeInteger(out.data() + 1, out.size(), width);
+  if (width < 8) {
+    storeInteger(out.data() + 1 + width, n, width);
+  }
+  return out;
+}
+
+// returns nanoseconds per lookup
+static double measure(Slice object, std::vector<std::string> const& keys,
+                      int runTime) {
+  using clock = std::chrono::steady_clock;
+  auto const end = clock::now() + std::chrono::milliseconds(runTime);
+  uint64_t lookups = 0;
+  uint64_t found = 0;
+  auto const start = clock::now();
+  while (clock::now() < end) {
+    for (auto const& key : keys) {
+      found += object.get(key).isNone() ? 0 : 1;
+    }
+    lookups += keys.size();
+  }
+  auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      clock::now() - start).count();
+  if (found != lookups) {
+    std::cerr << "lookup failed" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return static_cast<double>(elapsed) / static_cast<double>(lookups);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+  int runTime = (argc == 2) ? std::stoi(argv[1]) : 200;
+  if (runTime <= 0) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  std::size_t const widths[] = {1, 2, 4, 8};
+  std::size_t const sizes[] = {2, 3, 4, 5, 6, 8, 10, 12, 16, 24, 32, 64, 128,
+                               256, 512, 1024, 2048, 4096, 65536, 1048576};
+
+  std::mt19937 random(42);
+  std::cout << "members  width  sorted ns  linear ns" << std::endl;
+  for (std::size_t n : sizes) {
+    // the same random order of lookups for all widths
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < (std::min)(n * 4, std::size_t(4096)); ++i) {
+      keys.push_back(keyName(random() % n));
+    }
+
+    for (std::size_t width : widths) {
+      std::vector<uint8_t> data = makeObject(n, width);
+      if (data.empty()) {
+        continue;
+      }
+      double sorted = measure(Slice(data.data()), keys, runTime);
+      printf("%7zu  %5zu  %9.1f", n, width, sorted);
+      if (n <= 4096) {
+        // 0x0f to 0x12 are the unsorted variants of 0x0b to 0x0e
+        data[0] += 4;
+        printf("  %9.1f", measure(Slice(data.data()), keys, runTime));
+      }
+      printf("\n");
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -108,6 +108,15 @@ static void run(std::string& data, int runTime, size_t copies, bool useVPack,
     outputs.push_back(new Parser(&options));
   }
 
+  // the Parsers below keep their memory between runs, so count the
+  // reallocations of the output buffer with a fresh one
+  size_t reallocations = 0;
+  if (useVPack) {
+    Parser parser(&options);
+    parser.parse(inputs[0]);
+    reallocations = parser.builder().bufferRef().reallocations();
+  }
+
   size_t count = 0;
   size_t total = 0;
   auto start = std::chrono::high_resolution_clock::now();
@@ -144,12 +153,19 @@ static void run(std::string& data, int runTime, size_t copies, bool useVPack,
                 << "." << std::endl;
       std::cout << "Parsed " << inputs[0].size() * total << " bytes in total."
                 << std::endl;
+      if (useVPack) {
+        std::cout << "The output buffer was enlarged " << reallocations
+                  << " times per parse." << std::endl;
+      }
     }
     std::cout << "This is "
               << static_cast<double>(inputs[0].size() * total) /
                      totalTime.count() << " bytes/s"
-              << " or " << total / totalTime.count() << " JSON docs per second."
-              << std::endl;
+              << " or " << total / totalTime.count() << " JSON docs per second.";
+    if (!fullOutput && useVPack) {
+      std::cout << " Reallocations: " << reallocations << ".";
+    }
+    std::cout << std::endl;
   } catch (Exception const& ex) {
     std::cerr << "An exception occurred while running bench: " << ex.what()
               << std::endl;
@@ -191,6 +207,8 @@ static void runDefaultBench() {
   runComparison("sample.json");
   runComparison("sampleNoWhite.json");
   runComparison("commits.json");
+  runComparison("doubles.json");
+  runComparison("doubles-small.json");
 }
 
 int main(int argc, char* argv[]) {
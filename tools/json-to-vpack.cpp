@@ -24,6 +24,8 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -66,28 +68,83 @@ static void usage(char* argv[]) {
             << std::endl;
   std::cout << " --stringify     print a char array containing the generated VPack value"
             << std::endl;
+  std::cout << " --threads N     treat INFILE as newline-delimited JSON, parse it"
+            << std::endl;
+  std::cout << "                 with N threads and store the documents in an Array"
+            << std::endl;
+  std::cout << "                 (N = 0 uses all hardware threads)" << std::endl;
 }
 
 static inline bool isOption(char const* arg, char const* expected) {
   return (strcmp(arg, expected) == 0);
 }
 
+// upper bound for --threads
+static constexpr unsigned long MaxThreads = 1024;
+
+// parses the argument of --threads. returns false if it is not a
+// number between 0 and MaxThreads
+static bool parseThreads(char const* arg, std::size_t& threads) {
+  if (*arg < '0' || *arg > '9') {
+    // strtoul would skip whitespace and accept a sign
+    return false;
+  }
+  char* end;
+  errno = 0;
+  unsigned long value = std::strtoul(arg, &end, 10);
+  if (*end != '\0' || errno == ERANGE || value > MaxThreads) {
+    return false;
+  }
+  threads = static_cast<std::size_t>(value);
+  return true;
+}
+
+static void countKeys(Slice slice,
+                      std::unordered_map<std::string, size_t>& keysFound) {
+  Collection::visitRecursive(
+      slice, Collection::PreOrder,
+      [&keysFound](Slice const& key, Slice const&) -> bool {
+        if (key.isString()) {
+          keysFound[key.copyString()]++;
+        }
+        return true;
+      });
+}
+
 static bool buildCompressedKeys(
     std::string const& s, std::unordered_map<std::string, size_t>& keysFound) {
   Options options;
   Parser parser(&options);
   try {
-    parser.parse(s);
+    // there may be several documents when parsing NDJSON
+    parser.parse(s, true);
     std::shared_ptr<Builder> builder = parser.steal();
 
-    Collection::visitRecursive(
-        builder->slice(), Collection::PreOrder,
-        [&keysFound](Slice const& key, Slice const&) -> bool {
-          if (key.isString()) {
-            keysFound[key.copyString()]++;
-          }
-          return true;
-        });
+    uint8_t const* start = builder->start();
+    uint8_t const* end = start + builder->size();
+    while (start < end) {
+      Slice slice(start);
+      countKeys(slice, keysFound);
+      start += slice.byteSize();
+    }
+
+    return true;
+  } catch (...) {
+    // simply don't use compressed keys
+    return false;
+  }
+}
+
+// counts the keys of NDJSON input with the BatchParser that converts it
+// afterwards, so that the input is parsed with all of its threads
+static bool buildCompressedKeys(
+    BatchParser& parser, std::string const& s,
+    std::unordered_map<std::string, size_t>& keysFound) {
+  try {
+    parser.parse(s);
+    for (ValueLength i = 0; i < parser.size(); ++i) {
+      countKeys(parser[i], keysFound);
+    }
 
     return true;
   } catch (...) {
@@ -106,6 +163,8 @@ int main(int argc, char* argv[]) {
   bool compress = false;
   bool hexDump = false;
   bool stringify = false;
+  bool batch = false;
+  std::size_t threads = 0;
 
   int i = 1;
   while (i < argc) {
@@ -125,6 +184,18 @@ int main(int argc, char* argv[]) {
       hexDump = true;
     } else if (allowFlags && isOption(p, "--stringify")) {
       stringify = true;
+    } else if (allowFlags && isOption(p, "--threads")) {
+      if (++i >= argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      if (!parseThreads(argv[i], threads)) {
+        std::cerr << "Invalid number of threads '" << argv[i]
+                  << "', expecting a number between 0 and " << MaxThreads
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      batch = true;
     } else if (allowFlags && isOption(p, "--")) {
       allowFlags = false;
     } else if (infileName == nullptr) {
@@ -193,11 +264,22 @@ int main(int argc, char* argv[]) {
   options.buildUnindexedArrays = compact;
   options.buildUnindexedObjects = compact;
 
+  // the BatchParser is created up front to reuse its threads for
+  // counting keys
+  std::unique_ptr<BatchParser> batchParser;
+  if (batch) {
+    batchParser.reset(new BatchParser(&options, threads));
+  }
+
   // compress object keys?
   if (compress) {
     size_t compressedOccurrences = 0;
     std::unordered_map<std::string, size_t> keysFound;
-    buildCompressedKeys(s, keysFound);
+    if (batch) {
+      buildCompressedKeys(*batchParser, s, keysFound);
+    } else {
+      buildCompressedKeys(s, keysFound);
+    }
 
     std::vector<std::tuple<uint64_t, std::string, size_t>> stats;
     size_t requiredLength = 2;
@@ -236,18 +318,39 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  Parser parser(&options);
-  try {
-    parser.parse(s);
-  } catch (Exception const& ex) {
-    std::cerr << "An exception occurred while parsing infile '" << infile
-              << "': " << ex.what() << std::endl;
-    std::cerr << "Error position: " << parser.errorPos() << std::endl;
-    return EXIT_FAILURE;
-  } catch (...) {
-    std::cerr << "An unknown exception occurred while parsing infile '"
-              << infile << "'" << std::endl;
-    return EXIT_FAILURE;
+  std::shared_ptr<Builder> builder;
+  if (batch) {
+    // the options now contain the translator, if any
+    BatchParser& parser = *batchParser;
+    try {
+      parser.parse(s);
+    } catch (Exception const& ex) {
+      std::cerr << "An exception occurred while parsing infile '" << infile
+                << "': " << ex.what() << std::endl;
+      std::cerr << "Error position: " << parser.errorPos() << std::endl;
+      return EXIT_FAILURE;
+    } catch (...) {
+      std::cerr << "An unknown exception occurred while parsing infile '"
+                << infile << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    builder = std::make_shared<Builder>(&options);
+    parser.toArray(*builder);
+  } else {
+    Parser parser(&options);
+    try {
+      parser.parse(s);
+    } catch (Exception const& ex) {
+      std::cerr << "An exception occurred while parsing infile '" << infile
+                << "': " << ex.what() << std::endl;
+      std::cerr << "Error position: " << parser.errorPos() << std::endl;
+      return EXIT_FAILURE;
+    } catch (...) {
+      std::cerr << "An unknown exception occurred while parsing infile '"
+                << infile << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    builder = parser.steal();
   }
 
   std::ofstream ofs(outfileName, std::ofstream::out);
@@ -263,7 +366,6 @@ int main(int argc, char* argv[]) {
   }
 
   // write into stream
-  std::shared_ptr<Builder> builder = parser.steal();
   if (hexDump) {
     ofs << HexDump(builder->slice()) << std::endl;
   } else if (stringify) {